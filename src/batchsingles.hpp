@@ -0,0 +1,253 @@
+/*
+ *  batchsingles.hpp
+ *
+ */
+
+#ifndef BATCHSINGLES_HPP_20261019
+#define BATCHSINGLES_HPP_20261019
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "bitboardsingles.hpp"
+
+namespace Sudoku {
+
+/** BitboardSingles for several puzzles at once.  Every cell holds the candidate masks of the same cell in each of a number
+ *  of puzzles (one puzzle per lane) and each step of the rules is done to all the lanes with the same vector instructions,
+ *  which is worthwhile because the work per cell doesn't depend on the puzzle.  The vectors are GCC's generic vectors, so
+ *  they become AVX-512, AVX2 or SSE2 instructions depending on what the compiler is allowed to use and plain scalar code
+ *  on anything else.
+ *
+ *  The puzzles move through the lanes in lockstep, a pass over the grid at a time.  Within a lane the rules are applied in
+ *  the same order as BitboardSingles (naked singles until they stall, then hidden singles, then intersections) so a puzzle
+ *  comes out with the same result and the same rules used whichever of the two solves it.  As soon as a lane's puzzle is
+ *  solved, stalls or turns out to be contradictory it is retired and the next puzzle is loaded into the lane.
+ */
+class BatchSingles
+{
+public:
+	typedef BitboardSingles::Result Result;
+
+	/// Enough lanes for one register of 16 bit masks
+#if defined( __AVX512BW__ )
+	static const std::size_t lanes = 32;
+#elif defined( __AVX2__ )
+	static const std::size_t lanes = 16;
+#else
+	static const std::size_t lanes = 8;
+#endif
+
+	/// What became of one puzzle
+	struct Outcome
+	{
+		Result result;
+		bool nakedSingles;        ///< Whether each rule made progress
+		bool hiddenSingles;
+		bool intersections;
+		char values[81];          ///< If solved, the value of each cell
+		char candidates[729];     ///< If stalled, the candidates left in the form read by Grid::loadCandidates
+	};
+
+	/// Solve the puzzles (each 81 characters, '1'-'9' for a given) as far as the rules go
+	void solve( const char* const* puzzles, const std::size_t count, Outcome* outcomes )
+	{
+		std::size_t next = 0;
+		std::size_t busy = 0;
+		for( std::size_t lane = 0; lane != lanes; ++lane )
+		{
+			puzzleInLane_[lane] = count;
+			if( next != count ) { load( lane, puzzles[next], next ); ++next; ++busy; }
+			else                { clear( lane ); }
+		}
+
+		while( busy )
+		{
+			step();
+			for( std::size_t lane = 0; lane != lanes; ++lane )
+			{
+				if( puzzleInLane_[lane] == count || !finished_[lane] ) { continue; }
+				retire( lane, outcomes[puzzleInLane_[lane]] );
+				if( next != count ) { load( lane, puzzles[next], next ); ++next; }
+				else                { clear( lane ); puzzleInLane_[lane] = count; --busy; }
+			}
+		}
+	}
+
+private:
+	typedef BitboardSingles::Mask Mask;
+
+	/// The masks of one cell in every lane (only aligned as much as malloc guarantees so that a Solver can go on the heap)
+	typedef Mask Lanes __attribute__(( vector_size( lanes * sizeof( Mask ) ), aligned( 16 ) ));
+
+	static Lanes splat( const Mask mask )
+	{
+		Lanes result;
+		for( std::size_t lane = 0; lane != lanes; ++lane ) { result[lane] = mask; }
+		return result;
+	}
+
+	/// All ones in the lanes that are zero
+	static Lanes isZero( const Lanes masks ) { return (Lanes)( masks == Lanes() ); }
+
+	/// All ones in the lanes that have exactly one bit set
+	static Lanes isSingle( const Lanes masks ) { return ~isZero( masks ) & isZero( masks & ( masks - splat( 1 ) ) ); }
+
+	void load( const std::size_t lane, const char* givens, const std::size_t puzzle )
+	{
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			cells_[index][lane] = ( givens[index] >= '1' && givens[index] <= '9' ) ? 1 << ( givens[index] - '1' ) : BitboardSingles::allDigits;
+		}
+		nakedSingles_[lane] = hiddenSingles_[lane] = intersections_[lane] = 0;
+		puzzleInLane_[lane] = puzzle;
+	}
+
+	/// An idle lane, which never changes
+	void clear( const std::size_t lane )
+	{
+		for( std::size_t index = 0; index != 81; ++index ) { cells_[index][lane] = BitboardSingles::allDigits; }
+	}
+
+	void retire( const std::size_t lane, Outcome& outcome ) const
+	{
+		outcome.result = result_[lane];
+		outcome.nakedSingles = nakedSingles_[lane] != 0;
+		outcome.hiddenSingles = hiddenSingles_[lane] != 0;
+		outcome.intersections = intersections_[lane] != 0;
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			const Mask mask = cells_[index][lane];
+			if( outcome.result == BitboardSingles::solved )
+			{
+				outcome.values[index] = static_cast<char>( '1' + __builtin_ctz( mask ) );
+			}
+			else if( outcome.result == BitboardSingles::stalled )
+			{
+				for( std::size_t digit = 0; digit != 9; ++digit )
+				{
+					outcome.candidates[9 * index + digit] = ( mask & ( 1 << digit ) ) ? static_cast<char>( '1' + digit ) : '.';
+				}
+			}
+		}
+	}
+
+	/** One pass over the grid in every lane.  A lane that is left unchanged by the naked singles gets the hidden singles and
+	    one that is left unchanged by both gets the intersections.  Afterwards finished_ and result_ say which lanes are done.
+	*/
+	void step()
+	{
+		const GridGeometry& geometry = GridGeometry::instance();
+		const Lanes allDigits = splat( BitboardSingles::allDigits );
+
+		Lanes wasSingle[81];
+		Lanes placed[81];
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			wasSingle[index] = isSingle( cells_[index] );
+			placed[index] = Lanes();
+		}
+
+		// Naked singles: take the value of every solved cell out of its peers
+		Lanes changed = Lanes();
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			const Lanes value = cells_[index] & isSingle( cells_[index] );
+			for( std::size_t peer = 0; peer != 20; ++peer )
+			{
+				Lanes& other = cells_[geometry.peers[index][peer]];
+				changed |= other & value;
+				other &= ~value;
+			}
+		}
+		Lanes quiet = isZero( changed );
+
+		// Hidden singles: a digit with one spot left in a region goes there
+		Lanes broken = Lanes();
+		Lanes hidden = Lanes();
+		for( std::size_t region = 0; region != 27; ++region )
+		{
+			Lanes once = Lanes();
+			Lanes twice = Lanes();
+			for( std::size_t position = 0; position != 9; ++position )
+			{
+				const Lanes masks = cells_[geometry.regions[region][position]];
+				twice |= once & masks;
+				once |= masks;
+			}
+			broken |= ~isZero( once ^ allDigits );
+
+			const Lanes exactlyOnce = once & ~twice & quiet;
+			for( std::size_t position = 0; position != 9; ++position )
+			{
+				const std::size_t index = geometry.regions[region][position];
+				const Lanes digits = cells_[index] & exactlyOnce;
+				const Lanes placing = ~isZero( digits ) & ~isZero( digits ^ cells_[index] );
+				broken |= placing & ~isSingle( digits );  // Two digits that can only go in this cell
+				cells_[index] = ( digits & placing ) | ( cells_[index] & ~placing );
+				placed[index] |= placing;
+				hidden |= placing;
+			}
+		}
+		hiddenSingles_ |= hidden;
+		quiet &= isZero( hidden );
+
+		// Intersections: pointing and claiming
+		Lanes eliminated = Lanes();
+		for( std::size_t loop = 0; loop != 54; ++loop )
+		{
+			const GridGeometry::Intersection& intersection = geometry.intersections[loop];
+			Lanes inSegment = Lanes();
+			for( std::size_t cell = 0; cell != 3; ++cell ) { inSegment |= cells_[intersection.segment[cell]]; }
+			Lanes restOfSquare = Lanes();
+			Lanes restOfLine = Lanes();
+			for( std::size_t cell = 0; cell != 6; ++cell )
+			{
+				restOfSquare |= cells_[intersection.restOfSquare[cell]];
+				restOfLine |= cells_[intersection.restOfLine[cell]];
+			}
+
+			const Lanes pointing = inSegment & ~restOfSquare & restOfLine & quiet;
+			const Lanes claiming = inSegment & ~restOfLine & restOfSquare & quiet;
+			for( std::size_t cell = 0; cell != 6; ++cell )
+			{
+				Lanes& inLine = cells_[intersection.restOfLine[cell]];
+				eliminated |= inLine & pointing;
+				inLine &= ~pointing;
+				Lanes& inSquare = cells_[intersection.restOfSquare[cell]];
+				eliminated |= inSquare & claiming;
+				inSquare &= ~claiming;
+			}
+		}
+		intersections_ |= ~isZero( eliminated );
+
+		Lanes solved = ~Lanes();
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			const Lanes single = isSingle( cells_[index] );
+			nakedSingles_ |= single & ~wasSingle[index] & ~placed[index];
+			broken |= isZero( cells_[index] );
+			solved &= single;
+		}
+
+		const Lanes progress = ~isZero( changed | hidden | eliminated );
+		for( std::size_t lane = 0; lane != lanes; ++lane )
+		{
+			finished_[lane] = broken[lane] || !progress[lane];
+			result_[lane] = broken[lane] ? BitboardSingles::contradiction : ( solved[lane] ? BitboardSingles::solved : BitboardSingles::stalled );
+		}
+	}
+
+	Lanes cells_[81];
+	Lanes nakedSingles_;        ///< Lanes in which each rule has made progress
+	Lanes hiddenSingles_;
+	Lanes intersections_;
+	bool finished_[lanes];
+	Result result_[lanes];
+	std::size_t puzzleInLane_[lanes];  ///< The number of puzzles for an idle lane
+};
+
+} // namespace Sudoku
+
+#endif // BATCHSINGLES_HPP_20261019
@@ -0,0 +1,209 @@
+/*
+ *  benchmark.cpp
+ *
+ *  Time the solver over whole corpora of puzzles.
+ *
+ *  Usage: benchmark [-e] [-a] [-o results.json] [-r repetitions] [corpus_directory...]
+ *
+ *  Every puzzle file (.sdk, .csv, .txt or .sdb, but not .solution.csv) below each corpus directory is loaded into memory
+ *  before any timing starts, so only the solving is measured.  For each corpus the puzzles per second, the median, 99th 
+ *  percentile and maximum time per puzzle, and the invocations and time of each rule are reported.  With -o the same 
+ *  numbers are also written as JSON so that runs can be compared.  The puzzles go through a Solver, fast path and all, 
+ *  unless -e asks for the rule engine alone.  With -a the expensive rules are scheduled by what they have paid off on
+ *  the corpus so far (see RuleScheduler), each corpus starting afresh.
+ */
+
+#include "../solve.hpp"
+#include "../solver.hpp"
+#include "../corpusreader.hpp"
+using namespace Sudoku;
+
+#include <algorithm>
+using std::sort;
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <fstream>
+using std::ofstream;
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+
+/// The 81 givens of a puzzle
+struct Puzzle
+{
+	char givens[81];
+};
+
+struct CorpusResult
+{
+	string name;
+	std::size_t puzzles;
+	std::size_t solved;
+	uint64_t totalNanoseconds;
+	uint64_t p50;
+	uint64_t p99;
+	uint64_t max;
+	RuleStatistics statistics;
+};
+
+
+vector<Puzzle> loadCorpus( const string& directory )
+{
+	vector<string> filenames;
+	findPuzzleFiles( directory, filenames );
+	
+	vector<Puzzle> puzzles;
+	Puzzle puzzle;
+	for( vector<string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it )
+	{
+		CorpusReader reader( *it );
+		while( reader.next( puzzle.givens ) )
+		{
+			puzzles.push_back( puzzle );
+		}
+	}
+	return puzzles;
+}
+
+uint64_t percentile( const vector<uint64_t>& sortedLatencies, const double fraction )
+{
+	if( sortedLatencies.empty() ) { return 0; }
+	const std::size_t index = static_cast<std::size_t>( fraction * ( sortedLatencies.size() - 1 ) + 0.5 );
+	return sortedLatencies[index];
+}
+
+CorpusResult runCorpus( const string& directory, const std::size_t repetitions, const bool fastPath, const bool adaptive )
+{
+	const vector<Puzzle> puzzles = loadCorpus( directory );
+	
+	CorpusResult result;
+	result.name = directory;
+	result.puzzles = puzzles.size() * repetitions;
+	result.solved = 0;
+	result.totalNanoseconds = 0;
+	
+	SolveOptions options;
+	options.verbose = false;
+	options.statistics = &result.statistics;
+	options.fastPath = fastPath;
+	RuleScheduler scheduler;
+	options.scheduler = adaptive ? &scheduler : 0;
+	
+	Solver solver( options );
+	vector<uint64_t> latencies;
+	latencies.reserve( result.puzzles );
+	for( std::size_t repetition = 0; repetition != repetitions; ++repetition )
+	{
+		for( vector<Puzzle>::const_iterator it = puzzles.begin(); it != puzzles.end(); ++it )
+		{
+			const uint64_t start = nanoseconds();
+			if( solver.solve( it->givens ).solved() )
+			{
+				++result.solved;
+			}
+			latencies.push_back( nanoseconds() - start );
+			result.totalNanoseconds += latencies.back();
+		}
+	}
+	
+	sort( latencies.begin(), latencies.end() );
+	result.p50 = percentile( latencies, 0.50 );
+	result.p99 = percentile( latencies, 0.99 );
+	result.max = latencies.empty() ? 0 : latencies.back();
+	return result;
+}
+
+double puzzlesPerSecond( const CorpusResult& result )
+{
+	return result.totalNanoseconds ? result.puzzles * 1e9 / result.totalNanoseconds : 0.0;
+}
+
+void report( const CorpusResult& result )
+{
+	cout << result.name << ": " << result.solved << "/" << result.puzzles << " solved, " 
+	     << static_cast<uint64_t>( puzzlesPerSecond( result ) ) << " puzzles/s, "
+	     << "p50 " << result.p50 / 1000 << "us, p99 " << result.p99 / 1000 << "us, max " << result.max / 1000 << "us\n";
+	result.statistics.write( cout );
+}
+
+void writeJSON( const string& filename, const vector<CorpusResult>& results )
+{
+	ofstream fout( filename.c_str() );
+	fout << "{\"corpora\":[";
+	for( vector<CorpusResult>::const_iterator it = results.begin(); it != results.end(); ++it )
+	{
+		fout << ( it == results.begin() ? "\n" : ",\n" )
+		     << "{\"name\":\"" << it->name << "\",\"puzzles\":" << it->puzzles << ",\"solved\":" << it->solved
+		     << ",\"nanoseconds\":" << it->totalNanoseconds << ",\"puzzles_per_second\":" << puzzlesPerSecond( *it )
+		     << ",\"latency_ns\":{\"p50\":" << it->p50 << ",\"p99\":" << it->p99 << ",\"max\":" << it->max << "},\"rules\":[";
+		for( std::size_t entry = 0; entry != RuleStatistics::numberOfEntries; ++entry )
+		{
+			const RuleStatistics::Entry stats = it->statistics.total( entry );
+			fout << ( entry == 0 ? "" : "," ) << "{\"name\":\"" << RuleStatistics::name( entry ) 
+			     << "\",\"invocations\":" << stats.invocations << ",\"productive\":" << stats.productive 
+			     << ",\"eliminations\":" << stats.eliminations << ",\"nanoseconds\":" << stats.nanoseconds << "}";
+		}
+		fout << "]}";
+	}
+	fout << "\n]}\n";
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		string jsonFilename;
+		std::size_t repetitions = 1;
+		bool fastPath = true;
+		bool adaptive = false;
+		int argIndex = 1;
+		while( argIndex < argc && argv[argIndex][0] == '-' )
+		{
+			const string option = argv[argIndex++];
+			if( option == "-e" )      { fastPath = false; continue; }
+			if( option == "-a" )      { adaptive = true; continue; }
+			if( argIndex == argc )    { throw std::runtime_error( option + " needs a value" ); }
+			if( option == "-o" )      { jsonFilename = argv[argIndex++]; }
+			else if( option == "-r" ) { repetitions = std::strtoul( argv[argIndex++], 0, 10 ); }
+			else { throw std::runtime_error( "Usage: benchmark [-e] [-a] [-o results.json] [-r repetitions] [corpus_directory...]" ); }
+		}
+		
+		vector<string> directories( argv + argIndex, argv + argc );
+		if( directories.empty() )
+		{
+			const char* defaults[] = { "data/smh", "data/mx", "data/hls", "data/sudopedia", "data/crook-paper", "data/sadman", "data/lg", "data/legend_of_the_seas" };
+			directories.assign( defaults, defaults + sizeof(defaults)/sizeof(defaults[0]) );
+		}
+		
+		vector<CorpusResult> results;
+		for( vector<string>::const_iterator it = directories.begin(); it != directories.end(); ++it )
+		{
+			results.push_back( runCorpus( *it, repetitions, fastPath, adaptive ) );
+			report( results.back() );
+		}
+		
+		if( !jsonFilename.empty() )
+		{
+			writeJSON( jsonFilename, results );
+		}
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ *  microbench.cpp
+ *
+ *  Time each rule on its own against frozen grid states.
+ *
+ *  Usage: microbench -g snapshot_file puzzle_file...
+ *         microbench [-n iterations] snapshot_file
+ *
+ *  A snapshot file has one partially solved grid per line, written as the 729 candidate characters of Grid::candidates.
+ *  With -g the puzzles are stepped through the rules (in the same order as the solve) and a snapshot is saved each time 
+ *  Only Spot and Unique Per Constraint Region have stalled, i.e., whenever one of the harder rules is needed to make progress.
+ *
+ *  Otherwise every rule is applied, once, to every snapshot, over and over.  The grid is restored before each application and 
+ *  only the application itself is timed.  Because the inputs never change the numbers are stable from run to run, so a 
+ *  regression in a single rule shows up even when it would be lost in the noise of a whole solve.
+ */
+
+#include "../solve.hpp"
+#include "../corpusreader.hpp"
+using namespace Sudoku;
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+
+#include <iomanip>
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+
+const std::size_t snapshotSize = 729;
+
+/// The rules that are tried (in order) once the singles have stalled
+const RuleUsage::Rule harderRules[] = 
+{ 
+	RuleUsage::lockedTuples, RuleUsage::hiddenTuples, RuleUsage::xyzWing, RuleUsage::intersectReject, 
+	RuleUsage::gridlock, RuleUsage::singleValueChains, RuleUsage::multiValueChains 
+};
+const std::size_t numberOfHarderRules = sizeof(harderRules) / sizeof(harderRules[0]);
+
+
+/// Step each puzzle through the rules and save the states where a harder rule is needed.  Returns the number of snapshots.
+std::size_t generate( const string& snapshotFilename, const vector<string>& puzzleFilenames )
+{
+	ofstream fout( snapshotFilename.c_str() );
+	SolveOptions options;
+	options.verbose = false;
+	
+	std::size_t count = 0;
+	Grid grid;
+	RuleUsage usage;
+	char givens[81];
+	char snapshot[snapshotSize];
+	for( vector<string>::const_iterator it = puzzleFilenames.begin(); it != puzzleFilenames.end(); ++it )
+	{
+		CorpusReader reader( *it );
+		while( reader.next( givens ) )
+		{
+			grid.load( givens );
+			if( do_function( grid, Inconsistency(), RuleStatistics::consistencyCheck, options ) )
+			{
+				continue;
+			}
+			
+			bool progress = true;
+			while( progress )
+			{
+				while( applyRuleAndUnique( grid, RuleUsage::onlySpot, usage, options ) ){}
+				if( grid.candidateCount() == 81 )
+				{
+					break;  // Solved
+				}
+				
+				grid.candidates( snapshot );
+				fout.write( snapshot, snapshotSize ) << '\n';
+				++count;
+				
+				progress = false;
+				for( std::size_t rule = 0; rule != numberOfHarderRules && !progress; ++rule )
+				{
+					progress = applyRuleAndUnique( grid, harderRules[rule], usage, options );
+				}
+			}
+		}
+	}
+	return count;
+}
+
+vector<string> loadSnapshots( const string& snapshotFilename )
+{
+	ifstream fin( snapshotFilename.c_str() );
+	if( !fin )
+	{
+		throw std::runtime_error( "Unable to open " + snapshotFilename );
+	}
+	
+	vector<string> snapshots;
+	string line;
+	while( getline( fin, line ) )
+	{
+		if( line.size() >= snapshotSize )
+		{
+			snapshots.push_back( line.substr( 0, snapshotSize ) );
+		}
+	}
+	return snapshots;
+}
+
+void run( const string& snapshotFilename, const std::size_t iterations )
+{
+	const vector<string> snapshots = loadSnapshots( snapshotFilename );
+	cout << snapshots.size() << " snapshots, " << iterations << " iterations\n"
+	     << std::left << std::setw(30) << "Rule" << std::right << std::setw(14) << "applications" << std::setw(12) << "productive" 
+	     << std::setw(14) << "mean us" << std::setw(14) << "best us" << '\n';
+	
+	SolveOptions options;
+	options.verbose = false;
+	
+	Grid grid;
+	for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule )
+	{
+		uint64_t total = 0;
+		uint64_t best = 0;  // Sum over the snapshots of the fastest application
+		std::size_t productive = 0;
+		for( vector<string>::const_iterator it = snapshots.begin(); it != snapshots.end(); ++it )
+		{
+			uint64_t fastest = 0;
+			for( std::size_t iteration = 0; iteration != iterations; ++iteration )
+			{
+				grid.loadCandidates( it->data() );
+				const uint64_t start = nanoseconds();
+				const bool didWork = applyRule( grid, static_cast<RuleUsage::Rule>( rule ), options );
+				const uint64_t elapsed = nanoseconds() - start;
+				
+				total += elapsed;
+				fastest = ( iteration == 0 || elapsed < fastest ) ? elapsed : fastest;
+				productive += didWork ? 1 : 0;
+			}
+			best += fastest;
+		}
+		
+		const std::size_t applications = snapshots.size() * iterations;
+		cout << std::left << std::setw(30) << RuleStatistics::name( rule ) << std::right << std::setw(14) << applications 
+		     << std::setw(12) << productive 
+		     << std::setw(14) << std::fixed << std::setprecision(2) << ( applications ? total / 1000.0 / applications : 0.0 ) 
+		     << std::setw(14) << ( snapshots.empty() ? 0.0 : best / 1000.0 / snapshots.size() ) << '\n';
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		if( argc > 3 && string( argv[1] ) == "-g" )
+		{
+			const vector<string> puzzleFilenames( argv + 3, argv + argc );
+			cerr << "Saved " << generate( argv[2], puzzleFilenames ) << " snapshots to " << argv[2] << endl;
+			return 0;
+		}
+		
+		std::size_t iterations = 10;
+		int argIndex = 1;
+		if( argc > 3 && string( argv[1] ) == "-n" )
+		{
+			iterations = std::strtoul( argv[2], 0, 10 );
+			argIndex = 3;
+		}
+		if( argIndex + 1 != argc )
+		{
+			cerr << "Usage: microbench -g snapshot_file puzzle_file...\n"
+			     << "       microbench [-n iterations] snapshot_file" << endl;
+			return 1;
+		}
+		run( argv[argIndex], iterations );
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
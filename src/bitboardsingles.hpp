@@ -0,0 +1,247 @@
+/*
+ *  bitboardsingles.hpp
+ *
+ */
+
+#ifndef BITBOARDSINGLES_HPP_20261019
+#define BITBOARDSINGLES_HPP_20261019
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "gridgeometry.hpp"
+
+namespace Sudoku {
+
+/** A small, fast solver that only knows the simplest rules: naked singles, hidden singles and intersections (pointing and
+ *  claiming).  Each cell is a mask of its candidates and a placed value is removed from its peers straight away, so there
+ *  are no lists, no regions of pointers and no sweeps over cells that haven't changed.
+ *
+ *  Most puzzles need nothing more, so this is tried first and the full rule engine is only given the puzzles (with the
+ *  candidates already reduced) that this stalls on.  Nothing in it depends on the grid being 9x9, so it is written for
+ *  boxes of any order (see BoxTraits) and is also what solves the 4x4, 16x16 and 25x25 grids that the rule engine can't.
+ */
+template< std::size_t order >
+class BoxSingles
+{
+public:
+	typedef BoxGeometry<order> Geometry;
+	enum Result { solved, stalled, contradiction };
+
+	typedef typename Geometry::Mask Mask;  ///< Bit d is set for the digit d (the d+1th symbol)
+	static const Mask allDigits = Geometry::allDigits;
+
+	BoxSingles() : nakedSingles(0), hiddenSingles(0), intersections(0) {}
+
+	/// Load the puzzle (one character per cell, a symbol of BoxTraits for a given) and apply the rules until they stall
+	Result solve( const char* givens )
+	{
+		nakedSingles = hiddenSingles = intersections = 0;
+		queued_ = 0;
+		std::fill( cells_, cells_ + numberOfCells, Geometry::allDigits );
+		std::fill( placed_, placed_ + numberOfCells, false );
+		for( std::size_t index = 0; index != numberOfCells; ++index )
+		{
+			const int digit = Geometry::digit( givens[index] );
+			if( digit >= 0 )
+			{
+				cells_[index] = static_cast<Mask>( Mask(1) << digit );
+				placed_[index] = true;
+				queue_[queued_++] = static_cast<Index>( index );
+			}
+		}
+		if( !propagate() ) { return contradiction; }
+
+		for( ;; )
+		{
+			const int found = findHiddenSingles();
+			if( found < 0 || !propagate() ) { return contradiction; }
+			if( found > 0 ) { continue; }
+
+			const int eliminated = findIntersections();
+			if( eliminated < 0 || !propagate() ) { return contradiction; }
+			if( eliminated == 0 ) { break; }
+		}
+		return isSolved() ? solved : stalled;
+	}
+
+	Mask candidates( const std::size_t index ) const { return cells_[index]; }
+
+	/// Write the candidates (size characters per cell, the symbol or '.'), which for a 9x9 grid is the form read by Grid::loadCandidates
+	void candidates( char* candidateStates ) const
+	{
+		for( std::size_t index = 0; index != numberOfCells; ++index )
+		{
+			for( std::size_t digit = 0; digit != size; ++digit )
+			{
+				candidateStates[size * index + digit] = ( cells_[index] & ( Mask(1) << digit ) ) ? Geometry::symbol( digit ) : '.';
+			}
+		}
+	}
+
+	/// Write the value of each cell, '0' where it has more than one candidate
+	void values( char* cellValues ) const
+	{
+		for( std::size_t index = 0; index != numberOfCells; ++index )
+		{
+			cellValues[index] = isSingle( cells_[index] ) ? Geometry::symbol( __builtin_ctz( cells_[index] ) ) : '0';
+		}
+	}
+
+	// What was done during the last solve
+	std::size_t nakedSingles;    ///< Cells solved because they had one candidate left
+	std::size_t hiddenSingles;   ///< Cells solved because they were the only place for a digit in a region
+	std::size_t intersections;   ///< Candidates removed by pointing and claiming
+
+private:
+	typedef typename Geometry::Index Index;
+	static const std::size_t size = Geometry::size;
+	static const std::size_t numberOfCells = Geometry::numberOfCells;
+
+	static bool isSingle( const Mask mask ) { return mask && !( mask & ( mask - 1 ) ); }
+
+	bool isSolved() const
+	{
+		for( std::size_t index = 0; index != numberOfCells; ++index )
+		{
+			if( !isSingle( cells_[index] ) ) { return false; }
+		}
+		return true;
+	}
+
+	/// Queue a cell once it has a single candidate.  Returns false if it has none.
+	bool changed( const std::size_t index )
+	{
+		if( !cells_[index] ) { return false; }
+		if( isSingle( cells_[index] ) && !placed_[index] )
+		{
+			placed_[index] = true;  // Stops the cell being queued twice
+			queue_[queued_++] = static_cast<Index>( index );
+			++nakedSingles;
+		}
+		return true;
+	}
+
+	/// Remove each queued value from the peers of its cell (queueing any peer that is left with one candidate)
+	bool propagate()
+	{
+		const Geometry& geometry = Geometry::instance();
+		while( queued_ )
+		{
+			const std::size_t index = queue_[--queued_];
+			const Mask bit = cells_[index];
+			for( std::size_t peer = 0; peer != Geometry::numberOfPeers; ++peer )
+			{
+				const std::size_t other = geometry.peers[index][peer];
+				if( cells_[other] & bit )
+				{
+					cells_[other] &= ~bit;
+					if( !changed( other ) ) { return false; }
+				}
+			}
+		}
+		return true;
+	}
+
+	/// Place every digit that has only one spot in a region.  Returns the number placed or -1 if a region has no spot for a digit.
+	int findHiddenSingles()
+	{
+		const Geometry& geometry = Geometry::instance();
+		int found = 0;
+		for( std::size_t region = 0; region != Geometry::numberOfRegions; ++region )
+		{
+			// Bit sliced counts of each digit: once has the digits seen at least once, twice those seen at least twice
+			Mask once = 0;
+			Mask twice = 0;
+			for( std::size_t position = 0; position != size; ++position )
+			{
+				const Mask mask = cells_[geometry.regions[region][position]];
+				twice |= once & mask;
+				once |= mask;
+			}
+			if( once != Geometry::allDigits ) { return -1; }
+
+			const Mask exactlyOnce = once & ~twice;
+			if( !exactlyOnce ) { continue; }
+			for( std::size_t position = 0; position != size; ++position )
+			{
+				const std::size_t index = geometry.regions[region][position];
+				const Mask hidden = cells_[index] & exactlyOnce;
+				if( hidden && !placed_[index] )
+				{
+					if( !isSingle( hidden ) ) { return -1; }  // Two digits that can only go in this cell
+					cells_[index] = hidden;
+					placed_[index] = true;
+					queue_[queued_++] = static_cast<Index>( index );
+					++hiddenSingles;
+					++found;
+				}
+			}
+		}
+		return found;
+	}
+
+	/** Pointing (a digit confined to one row or column of a square is removed from the rest of that line) and claiming
+	    (a digit confined to one square within a line is removed from the rest of that square).
+	    Returns the number of candidates removed or -1 if a cell is left with none.
+	*/
+	int findIntersections()
+	{
+		const Geometry& geometry = Geometry::instance();
+		int eliminated = 0;
+		for( std::size_t loop = 0; loop != Geometry::numberOfIntersections; ++loop )
+		{
+			const typename Geometry::Intersection& intersection = geometry.intersections[loop];
+			Mask inSegment = 0;
+			for( std::size_t cell = 0; cell != order; ++cell ) { inSegment |= cells_[intersection.segment[cell]]; }
+
+			Mask restOfSquare = 0;
+			Mask restOfLine = 0;
+			for( std::size_t cell = 0; cell != size - order; ++cell )
+			{
+				restOfSquare |= cells_[intersection.restOfSquare[cell]];
+				restOfLine   |= cells_[intersection.restOfLine[cell]];
+			}
+
+			const Mask pointing = inSegment & ~restOfSquare & restOfLine;
+			const Mask claiming = inSegment & ~restOfLine & restOfSquare;
+			if( !pointing && !claiming ) { continue; }
+
+			for( std::size_t cell = 0; cell != size - order; ++cell )
+			{
+				const std::size_t inLine = intersection.restOfLine[cell];
+				const std::size_t inSquare = intersection.restOfSquare[cell];
+				if( cells_[inLine] & pointing )
+				{
+					eliminated += __builtin_popcount( cells_[inLine] & pointing );
+					cells_[inLine] &= ~pointing;
+					if( !changed( inLine ) ) { return -1; }
+				}
+				if( cells_[inSquare] & claiming )
+				{
+					eliminated += __builtin_popcount( cells_[inSquare] & claiming );
+					cells_[inSquare] &= ~claiming;
+					if( !changed( inSquare ) ) { return -1; }
+				}
+			}
+		}
+		intersections += eliminated;
+		return eliminated;
+	}
+
+	Mask cells_[numberOfCells];
+	bool placed_[numberOfCells];          ///< The cell's value has been (or is queued to be) removed from its peers
+	Index queue_[numberOfCells];
+	std::size_t queued_;
+};
+
+template< std::size_t order > const typename BoxSingles<order>::Mask BoxSingles<order>::allDigits;
+
+/// The singles for the usual 9x9 grid, tried before the rule engine
+typedef BoxSingles<3> BitboardSingles;
+
+} // namespace Sudoku
+
+#endif // BITBOARDSINGLES_HPP_20261019
@@ -0,0 +1,173 @@
+/*
+ *  boundedqueue.hpp
+ *
+ */
+
+#ifndef BOUNDEDQUEUE_HPP_20261019
+#define BOUNDEDQUEUE_HPP_20261019
+
+#include <stdint.h>
+#include <sched.h>
+#include <time.h>
+
+#include <vector>
+using std::vector;
+
+namespace Sudoku {
+
+/// Wait a little before retrying.  Spin briefly, then give up the processor, and finally sleep so that a long wait doesn't burn a core.
+inline void backoff( const std::size_t attempt )
+{
+	if( attempt < 64 )
+	{
+		return;
+	}
+	else if( attempt < 1024 )
+	{
+		sched_yield();
+	}
+	else
+	{
+		timespec pause = { 0, 50000 };
+		nanosleep( &pause, 0 );
+	}
+}
+
+
+/** A fixed capacity, lock-free queue that is safe for any number of producers and consumers.
+ *  Each slot carries a sequence number which says whether the slot is ready to be written (sequence == position) or 
+ *  ready to be read (sequence == position + 1).  Producers and consumers claim positions with a compare and swap so
+ *  the only shared writes are to the two position counters and the slot being handed over.  
+ *  (This is Dmitry Vyukov's bounded MPMC queue.)
+ *
+ *  push and pop wait (spinning, then yielding, then sleeping) while the queue is full or empty.  A full queue is what
+ *  stops a fast producer from running arbitrarily far ahead of its consumers.
+ */
+template< typename T >
+class BoundedQueue
+{
+public:
+	/// The capacity is rounded up to a power of two
+	explicit BoundedQueue( const std::size_t capacity )
+		: slots_( roundUpToPowerOfTwo( capacity ) )
+		, mask_( slots_.size() - 1 )
+		, enqueuePosition_(0)
+		, dequeuePosition_(0)
+	{
+		for( std::size_t loop = 0; loop != slots_.size(); ++loop )
+		{
+			slots_[loop].sequence = loop;
+		}
+	}
+	
+	std::size_t capacity() const { return slots_.size(); }
+	
+	/// Add the item unless the queue is full
+	bool tryPush( const T& item )
+	{
+		std::size_t position = __atomic_load_n( &enqueuePosition_, __ATOMIC_RELAXED );
+		Slot* slot = 0;
+		for( ;; )
+		{
+			slot = &slots_[position & mask_];
+			const std::size_t sequence = __atomic_load_n( &slot->sequence, __ATOMIC_ACQUIRE );
+			const intptr_t difference = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( position );
+			if( difference == 0 )
+			{
+				if( __atomic_compare_exchange_n( &enqueuePosition_, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+				{
+					break;
+				}
+			}
+			else if( difference < 0 )
+			{
+				return false;  // Full
+			}
+			else
+			{
+				position = __atomic_load_n( &enqueuePosition_, __ATOMIC_RELAXED );
+			}
+		}
+		slot->item = item;
+		__atomic_store_n( &slot->sequence, position + 1, __ATOMIC_RELEASE );
+		return true;
+	}
+	
+	/// Remove the oldest item unless the queue is empty
+	bool tryPop( T& item )
+	{
+		std::size_t position = __atomic_load_n( &dequeuePosition_, __ATOMIC_RELAXED );
+		Slot* slot = 0;
+		for( ;; )
+		{
+			slot = &slots_[position & mask_];
+			const std::size_t sequence = __atomic_load_n( &slot->sequence, __ATOMIC_ACQUIRE );
+			const intptr_t difference = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( position + 1 );
+			if( difference == 0 )
+			{
+				if( __atomic_compare_exchange_n( &dequeuePosition_, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+				{
+					break;
+				}
+			}
+			else if( difference < 0 )
+			{
+				return false;  // Empty
+			}
+			else
+			{
+				position = __atomic_load_n( &dequeuePosition_, __ATOMIC_RELAXED );
+			}
+		}
+		item = slot->item;
+		__atomic_store_n( &slot->sequence, position + mask_ + 1, __ATOMIC_RELEASE );
+		return true;
+	}
+	
+	void push( const T& item )
+	{
+		for( std::size_t attempt = 0; !tryPush( item ); ++attempt )
+		{
+			backoff( attempt );
+		}
+	}
+	
+	void pop( T& item )
+	{
+		for( std::size_t attempt = 0; !tryPop( item ); ++attempt )
+		{
+			backoff( attempt );
+		}
+	}
+
+private:
+	BoundedQueue( const BoundedQueue& );             // Not copyable
+	BoundedQueue& operator=( const BoundedQueue& );
+	
+	struct Slot
+	{
+		std::size_t sequence;
+		T item;
+	};
+	
+	static std::size_t roundUpToPowerOfTwo( const std::size_t capacity )
+	{
+		std::size_t result = 2;
+		while( result < capacity )
+		{
+			result *= 2;
+		}
+		return result;
+	}
+	
+	vector<Slot> slots_;
+	const std::size_t mask_;
+	char padding0_[64];               // Keep the producer and consumer positions on separate cache lines
+	std::size_t enqueuePosition_;
+	char padding1_[64];
+	std::size_t dequeuePosition_;
+};
+
+} // namespace Sudoku
+
+#endif // BOUNDEDQUEUE_HPP_20261019
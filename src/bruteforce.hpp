@@ -0,0 +1,166 @@
+/*
+ *  bruteforce.hpp
+ *
+ */
+
+#ifndef BRUTEFORCE_HPP_20261019
+#define BRUTEFORCE_HPP_20261019
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Sudoku {
+
+/** A plain backtracking solver.  It knows nothing about the rules, which is the point: it is the oracle that the rules are
+ *  checked against.  Each row, column and square keeps a bit mask of the digits placed in it and the search always branches
+ *  on the empty cell with the fewest candidates.
+ *
+ *  Puzzles and solutions are 81 characters, '1'..'9' for a value and '0' for an empty cell (as used by Grid::load).
+ */
+class BruteForce
+{
+public:
+	BruteForce() : random_(0) {}
+
+	/** Solve the puzzle, stopping once limit solutions have been found.  Returns the number of solutions found (so a
+	    limit of 2 tells a unique puzzle from one with several solutions).  The first solution found is written to solution.
+	*/
+	std::size_t solve( const char* givens, char* solution, const std::size_t limit = 2 )
+	{
+		if( !load( givens ) )
+		{
+			return 0;
+		}
+		solution_ = solution;
+		limit_ = limit;
+		found_ = 0;
+		search();
+		return found_;
+	}
+
+	/// Write a random complete grid.  The same seed always gives the same grid.
+	void randomSolution( char* solution, uint32_t seed )
+	{
+		random_ = seed ? seed : 1;
+		char empty[81];
+		std::memset( empty, '0', 81 );
+		solve( empty, solution, 1 );
+		random_ = 0;
+	}
+
+private:
+	typedef uint16_t Mask;  ///< Bit d-1 is set for the digit d
+	static const Mask allDigits = 0x1ff;
+
+	static std::size_t squareOf( const std::size_t index ) { return 3 * ( index / 27 ) + ( index % 9 ) / 3; }
+
+	Mask used( const std::size_t index ) const
+	{
+		return rows_[index / 9] | columns_[index % 9] | squares_[squareOf( index )];
+	}
+
+	void place( const std::size_t index, const Mask bit )
+	{
+		rows_[index / 9] ^= bit;
+		columns_[index % 9] ^= bit;
+		squares_[squareOf( index )] ^= bit;
+	}
+
+	/// Returns false if the givens already clash
+	bool load( const char* givens )
+	{
+		std::fill( rows_, rows_ + 9, 0 );
+		std::fill( columns_, columns_ + 9, 0 );
+		std::fill( squares_, squares_ + 9, 0 );
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			cells_[index] = ( givens[index] >= '1' && givens[index] <= '9' ) ? givens[index] : '0';
+			if( cells_[index] != '0' )
+			{
+				const Mask bit = 1 << ( cells_[index] - '1' );
+				if( used( index ) & bit )
+				{
+					return false;
+				}
+				place( index, bit );
+			}
+		}
+		return true;
+	}
+
+	/// xorshift32, only used by randomSolution
+	uint32_t nextRandom()
+	{
+		random_ ^= random_ << 13;
+		random_ ^= random_ >> 17;
+		random_ ^= random_ << 5;
+		return random_;
+	}
+
+	void search()
+	{
+		// Find the empty cell with the fewest candidates
+		std::size_t best = 81;
+		int fewest = 10;
+		for( std::size_t index = 0; index != 81 && fewest > 1; ++index )
+		{
+			if( cells_[index] == '0' )
+			{
+				const int count = __builtin_popcount( allDigits & ~used( index ) );
+				if( count < fewest )
+				{
+					fewest = count;
+					best = index;
+				}
+			}
+		}
+
+		if( best == 81 )
+		{
+			if( found_++ == 0 )
+			{
+				std::memcpy( solution_, cells_, 81 );
+			}
+			return;
+		}
+
+		// Try the digits in order or, for randomSolution, in a shuffled order
+		std::size_t digits[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+		if( random_ )
+		{
+			for( std::size_t last = 8; last != 0; --last )
+			{
+				std::swap( digits[last], digits[nextRandom() % ( last + 1 )] );
+			}
+		}
+		
+		const Mask candidates = allDigits & ~used( best );
+		for( std::size_t step = 0; step != 9 && found_ < limit_; ++step )
+		{
+			const Mask bit = 1 << digits[step];
+			if( candidates & bit )
+			{
+				cells_[best] = '1' + static_cast<char>( digits[step] );
+				place( best, bit );
+				search();
+				place( best, bit );
+				cells_[best] = '0';
+			}
+		}
+	}
+
+	Mask rows_[9];
+	Mask columns_[9];
+	Mask squares_[9];
+	char cells_[81];
+	char* solution_;
+	std::size_t limit_;
+	std::size_t found_;
+	uint32_t random_;
+};
+
+} // namespace Sudoku
+
+#endif // BRUTEFORCE_HPP_20261019
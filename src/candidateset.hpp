@@ -0,0 +1,179 @@
+/*
+ *  candidateset.hpp
+ *
+ */
+
+#ifndef CANDIDATESET_HPP_20261019
+#define CANDIDATESET_HPP_20261019
+
+#include <stdint.h>
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+namespace Sudoku {
+
+/** The candidates of a cell as a 9 bit mask (bit d-1 for the digit d) behind the interface of the std::list<char> that
+ *  it replaced.  The candidates are always in ascending order and each can only be present once, which is how the rules
+ *  always used the list anyway.
+ *
+ *  Iterators follow the set rather than a snapshot of it, so removing any candidate (even the one an iterator is at)
+ *  doesn't upset an iteration in progress.  The values can't be changed through an iterator.
+ */
+class CandidateSet
+{
+public:
+	typedef uint16_t Mask;
+	static const Mask allDigits = 0x1ff;
+
+	typedef char value_type;
+	typedef const char& const_reference;
+	typedef const char& reference;
+	typedef std::size_t size_type;
+
+	class const_iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef char value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const char* pointer;
+		typedef char reference;
+
+		const_iterator() : mask_(0), digit_(9) {}
+
+		char operator*() const { return static_cast<char>( '1' + digit_ ); }
+
+		const_iterator& operator++()
+		{
+			const unsigned int above = *mask_ & ~( ( 2u << digit_ ) - 1 );
+			digit_ = above ? __builtin_ctz( above ) : 9;
+			return *this;
+		}
+		const_iterator operator++( int ) { const_iterator previous( *this ); ++*this; return previous; }
+
+		const_iterator& operator--()
+		{
+			const unsigned int below = *mask_ & ( ( 1u << digit_ ) - 1 );
+			assert( below );
+			digit_ = 31 - __builtin_clz( below );
+			return *this;
+		}
+		const_iterator operator--( int ) { const_iterator previous( *this ); --*this; return previous; }
+
+		bool operator==( const const_iterator& other ) const { return digit_ == other.digit_; }
+		bool operator!=( const const_iterator& other ) const { return digit_ != other.digit_; }
+
+	private:
+		friend class CandidateSet;
+		const_iterator( const Mask* mask, const int digit ) : mask_( mask ), digit_( digit ) {}
+
+		const Mask* mask_;
+		int digit_;           ///< 0-8, or 9 at the end
+	};
+	typedef const_iterator iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef const_reverse_iterator reverse_iterator;
+
+	explicit CandidateSet( const Mask mask = 0 ) : mask_( mask ) {}
+	CandidateSet( const CandidateSet& other ) : mask_( other.mask_ ) {}
+	CandidateSet& operator=( const CandidateSet& other ) { mask_ = other.mask_; return *this; }
+
+	const_iterator begin() const { return const_iterator( &mask_, mask_ ? __builtin_ctz( mask_ ) : 9 ); }
+	const_iterator end() const   { return const_iterator( &mask_, 9 ); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator( end() ); }
+	const_reverse_iterator rend() const   { return const_reverse_iterator( begin() ); }
+
+	size_type size() const
+	{
+		// Count the bits in place (__builtin_popcount is a library call unless the target has a popcount instruction)
+		unsigned int count = mask_ - ( ( mask_ >> 1 ) & 0x5555 );
+		count = ( count & 0x3333 ) + ( ( count >> 2 ) & 0x3333 );
+		count = ( count + ( count >> 4 ) ) & 0x0f0f;
+		return ( count + ( count >> 8 ) ) & 0x1f;
+	}
+	bool empty() const     { return mask_ == 0; }
+
+	void clear()                       { mask_ = 0; }
+	void push_back( const char value ) { mask_ |= bit( value ); }
+	void remove( const char value )    { mask_ &= ~bit( value ); }
+
+	const_iterator erase( const_iterator position )
+	{
+		const_iterator next( position );
+		++next;
+		remove( *position );
+		return next;
+	}
+
+	bool contains( const char value ) const { return ( mask_ & bit( value ) ) != 0; }
+
+	Mask mask() const { return mask_; }
+	void assign( const Mask mask ) { mask_ = mask; }
+
+	/// The bit for a value from '1' to '9'
+	static Mask bit( const char value )
+	{
+		assert( value >= '1' && value <= '9' );
+		return static_cast<Mask>( 1u << ( value - '1' ) );
+	}
+
+private:
+	Mask mask_;
+};
+
+
+/** How many times each candidate appears in a region, as bit sliced counters: bit d-1 of ones, twos, fours and eights 
+ *  are the bits of the count for the digit d.  Adding a cell's mask is a ripple carry through the four masks, so all nine
+ *  digits are counted at once with a handful of logical operations per cell, and questions like "which digits appear
+ *  exactly once" are answered with a few more.
+ */
+struct CandidateCounts
+{
+	typedef CandidateSet::Mask Mask;
+
+	CandidateCounts() : ones(0), twos(0), fours(0), eights(0) {}
+
+	void add( const Mask mask )
+	{
+		const Mask carryOnes = ones & mask;
+		ones ^= mask;
+		const Mask carryTwos = twos & carryOnes;
+		twos ^= carryOnes;
+		const Mask carryFours = fours & carryTwos;
+		fours ^= carryTwos;
+		eights |= carryFours;
+	}
+
+	/// The digits that appear exactly count times
+	Mask exactly( const std::size_t count ) const
+	{
+		return ( count & 1 ? ones : ~ones ) & ( count & 2 ? twos : ~twos ) & ( count & 4 ? fours : ~fours ) 
+		     & ( count & 8 ? eights : ~eights ) & CandidateSet::allDigits;
+	}
+
+	/// The digits that appear at least low times and no more than high times
+	Mask between( const std::size_t low, const std::size_t high ) const
+	{
+		Mask digits = 0;
+		for( std::size_t count = low; count <= high; ++count ) { digits |= exactly( count ); }
+		return digits;
+	}
+
+	/// The number of times the value ('1'-'9') appears
+	std::size_t count( const char value ) const
+	{
+		const std::size_t digit = value - '1';
+		return ( ( ones >> digit ) & 1 ) | ( ( ( twos >> digit ) & 1 ) << 1 ) | ( ( ( fours >> digit ) & 1 ) << 2 ) | ( ( ( eights >> digit ) & 1 ) << 3 );
+	}
+
+	Mask ones;
+	Mask twos;
+	Mask fours;
+	Mask eights;
+};
+
+} // namespace Sudoku
+
+#endif // CANDIDATESET_HPP_20261019
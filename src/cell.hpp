@@ -8,23 +8,30 @@ using std::ostream;
 #include <cassert>
 #include <stdexcept>
 
+#include "candidateset.hpp"
 #include "constraintregion.hpp"
 
 namespace Sudoku {
 
+struct Grid;
+
 /**
  *  A Cell is an individual location inside the Sudoku grid.  
- *  It contains a list of candidates (i.e., the remaining potential valid solutions)
+ *  It contains a set of candidates (i.e., the remaining potential valid solutions)
  *  and understands its location in the grid.
  *
+ *  The candidates are only changed through remove and assign, which tell the grid the cell belongs to (if any) so that it
+ *  can keep its counts up to date (see Grid::candidatesChanged).
  */
 class Cell
 {
 public:
-    typedef std::list<char> CandidateContainer;
+    typedef CandidateSet CandidateContainer;
     
-    Cell( const std::size_t cellIndex )
-        : initial_( false )
+    Cell( const std::size_t cellIndex, Grid* grid = 0 )
+        : grid_( grid )
+        , initial_( false )
+        , propagated_( false )
         , cellIndex_( cellIndex )
 		, row_( cellIndex/9 )   // Note that we are relying on the round down of integer division.
 	    , column_( cellIndex_ % 9 )
@@ -36,21 +43,38 @@ public:
 		const std::size_t squareColumn = column_ / 3;
 		square_ = 3*squareRow + squareColumn;
 
-		// A cell will be initialised with the full set of possible candidates (i.e., 1,2,3,...,9)
-		for( char value = '1'; value != ':'; ++value )  // ':' is the character after '9' in ascii
-        {
-            candidates_.push_back( value );
-        }
+		reset();
     }
 
     // Accessor
-    CandidateContainer& candidates()             { return candidates_; }
     const CandidateContainer& candidates() const { return candidates_; }
+    
+    // Remove a candidate.  Returns true if it was there.
+    bool remove( const char value )
+    {
+        if( !candidates_.contains( value ) )
+        {
+            return false;
+        }
+        const CandidateSet::Mask before = candidates_.mask();
+        candidates_.remove( value );
+        changed( before );
+        return true;
+    }
+    
+    // Replace the candidates with those in the mask
+    void assign( const CandidateSet::Mask mask )
+    {
+        const CandidateSet::Mask before = candidates_.mask();
+        candidates_.assign( mask );
+        changed( before );
+    }
 
 	std::size_t index()  const { return cellIndex_; }
 	std::size_t row()    const {	return row_; }
 	std::size_t column() const { return column_; }
 	std::size_t square() const {	return square_; }
+	void square( const std::size_t square ) { square_ = square; }  // For the irregular squares of a jigsaw (see Grid::addRegions)
 	std::size_t index( Constraint::Type type ) const
 	{
 		switch( type )
@@ -64,15 +88,34 @@ public:
 	}
 	
 
+    // Forget any solving (and the initial value) so that the cell can be reused for another puzzle.  The grid isn't told:
+    // it resets its counts for all the cells at once (see Grid::reset).
+    void reset()
+    {
+        initial_ = false;
+        propagated_ = false;
+        candidates_.clear();
+		
+		// A cell will be initialised with the full set of possible candidates (i.e., 1,2,3,...,9)
+		for( char value = '1'; value != ':'; ++value )  // ':' is the character after '9' in ascii
+        {
+            candidates_.push_back( value );
+        }
+    }
+
     // Reduce the set of candidates to the specifed value
     void initial( const char value )
     {
         initial_ = true;
-        candidates_.clear();  // remove all the unnecessary candidates.
-        candidates_.push_back( value );
+        propagated_ = false;
+        assign( CandidateSet::bit( value ) );  // remove all the unnecessary candidates.
     }
     
-    char initial() { return initial_; }
+    bool initial() const { return initial_; }
+    
+    // Has the value of this (solved) cell been removed from all of its peers (see UniquePerConstraintRegion::propagate)
+    bool propagated() const { return propagated_; }
+    void propagated( const bool done ) { propagated_ = done; }
     
     char value()
     {
@@ -116,8 +159,12 @@ public:
 	}	
 	
 private:
+    inline void changed( const CandidateSet::Mask before );  // Tell the grid (defined with Grid)
+    
+    Grid* grid_;                      // The grid that keeps count of the candidates, if any
     CandidateContainer candidates_;   // What are the remaining candidate values for this cell.  If only one candidate is left, that is the answer
     bool initial_;                    // Is the value in this cell the one specified in the initial problem
+    bool propagated_;                 // Has the value been removed from the peers of the cell
     std::size_t cellIndex_;                // Where in the overall Sudoku grid does this cell lie (numbers are 0 to 80, top left cell is 0, bottom right is 80, proceeding along the row)
     std::size_t row_;                      // Finer grained location. What row does this cell belong to.  Note the zero based index.
 	std::size_t column_;                   // Finer grained location. What column does this cell belong to.  Note the zero based index.
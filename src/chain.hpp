@@ -16,14 +16,14 @@ namespace Sudoku {
 typedef vector< Cell* > Chain;	
 	
 
-ostream& writeRawChain( ostream& os, const Chain& chain, const string& preamble )
+inline ostream& writeRawChain( ostream& os, const Chain& chain, const string& preamble )
 {
 	os << preamble;
 	copy( chain.begin(), chain.end(), std::ostream_iterator<Cell*>(os) );	
 	return os;
 }
 
-ostream& writeChain( ostream& os, const Chain& chain, const string& preamble = string() )
+inline ostream& writeChain( ostream& os, const Chain& chain, const string& preamble = string() )
 {
 	os << preamble;
 	for( Chain::const_iterator it = chain.begin(); it != chain.end(); ++it )
@@ -33,7 +33,7 @@ ostream& writeChain( ostream& os, const Chain& chain, const string& preamble = s
 	return os;
 }
 
-ostream& writeChainWithValues( ostream& os, const Chain& chain, const string& preamble = string() )
+inline ostream& writeChainWithValues( ostream& os, const Chain& chain, const string& preamble = string() )
 {
 	os << preamble;
 	for( Chain::const_iterator it = chain.begin(); it != chain.end(); ++it )
@@ -46,7 +46,7 @@ ostream& writeChainWithValues( ostream& os, const Chain& chain, const string& pr
 	
 	
 // Return true if the chains are identical
-bool identicalChain( Chain chain0_clone, Chain chain1_clone, bool print=false )
+inline bool identicalChain( Chain chain0_clone, Chain chain1_clone, bool print=false )
 {
 	if( chain0_clone.size() == chain1_clone.size() )
 	{
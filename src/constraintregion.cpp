@@ -7,6 +7,7 @@
 
 #include "constraintregion.hpp"
 #include "cell.hpp"
+#include "grid.hpp"
 using namespace Sudoku;
 
 #include <iostream>
@@ -46,13 +47,23 @@ void PrintCellLocationInformation::operator()( const ConstraintRegion& cr )
  *  Constraint definitions
  */
 	
-/// Is the constraint region a row, column or square?
+/// Is the constraint region a row, column or square (or an extra region if it is none of them)?
 Constraint::Type Constraint::calculateType( const ConstraintRegion& cr )
 {
-	if( cr[0]->row() == cr[4]->row() )           { assert(    cr[0]->row() == cr[8]->row()    ); return Constraint::row; }
-	else if( cr[0]->column() == cr[4]->column() ){ assert( cr[0]->column() == cr[8]->column() ); return Constraint::column; }
-	else if( cr[0]->square() == cr[4]->square() ){ assert( cr[0]->square() == cr[8]->square() ); return Constraint::square; }
-	else { assert(false); return static_cast<Type>(-1); }
+	// An extra region can share a row, column or square with some of its cells, so every cell has to be checked
+	bool sameRow = true;
+	bool sameColumn = true;
+	bool sameSquare = true;
+	for( ConstraintRegion::const_iterator crIt = cr.begin() + 1; crIt != cr.end(); ++crIt )
+	{
+		sameRow    &= (*crIt)->row() == cr[0]->row();
+		sameColumn &= (*crIt)->column() == cr[0]->column();
+		sameSquare &= (*crIt)->square() == cr[0]->square();
+	}
+	if( sameRow )         { return Constraint::row; }
+	else if( sameColumn ) { return Constraint::column; }
+	else if( sameSquare ) { return Constraint::square; }
+	else                  { return Constraint::extra; }
 }
 
 /// If the constraint type is a row then return a column (and vice versa).  Undefined for squares.
@@ -80,6 +91,9 @@ string Constraint::typeToStr( const Constraint::Type type )
 	case grid:
 		return "grid";
 		break;
+	case extra:
+		return "extra";
+		break;
 	default:
 		assert(false);
 		return "";
@@ -88,29 +102,23 @@ string Constraint::typeToStr( const Constraint::Type type )
 }
 
 
-/// If the constraint region is a row then return the row number.  Similarly for columns and squares.
+/// If the constraint region is a row then return the row number.  Similarly for columns and squares.  For an extra region, its first cell.
 std::size_t Constraint::calculateConstantIndex( const ConstraintRegion& cr )
 {
 	Type regionType = calculateType( cr );
-	return cr[0]->index( regionType );
+	return cr[0]->index( regionType == extra ? grid : regionType );
 }
 
 
-/// Return a frequency table of the candidates in the given constraint region	
-vector<std::size_t> Constraint::buildCandidateFrequencyTable( const ConstraintRegion& cr )
+/// Count how many times each candidate appears in the given constraint region
+CandidateCounts Constraint::countCandidates( const ConstraintRegion& cr )
 {
-	// Create a vector of many elements initialised to zero. Despite the waste of memory, we wont use the first n element, only using '1' - '9'.
-	vector<std::size_t> frequency(':');  
-	
+	CandidateCounts counts;
 	for( ConstraintRegion::const_iterator crIt = cr.begin(); crIt != cr.end(); ++crIt )
 	{
-		for( Cell::CandidateContainer::const_iterator candidateIt = (*crIt)->candidates().begin(); candidateIt != (*crIt)->candidates().end(); ++candidateIt )
-		{						
-			++frequency[*candidateIt];  				
-			//std::cout << "Updating frequency of value (" << *candidateIt << ") to be " << frequency[*candidateIt] << std::endl;
-		}
-	}	
-	return frequency;
+		counts.add( (*crIt)->candidates().mask() );
+	}
+	return counts;
 }	
 
 /// Return a frequency table of the candidates in the given constraint region	
@@ -133,7 +141,7 @@ vector<Cell*> Constraint::findCandidateValue( const ConstraintRegion& cr, const
 	for( ConstraintRegion::const_iterator crIt = cr.begin(); crIt != cr.end(); ++crIt )
 	{
 		const Cell::CandidateContainer& currentCandidates = (*crIt)->candidates();
-		if( find(currentCandidates.begin(), currentCandidates.end(), candidateValue) != currentCandidates.end() )
+		if( currentCandidates.contains( candidateValue ) )
 		{
 			cellsWithCandidateValue.push_back( *crIt );
 		}
@@ -148,7 +156,7 @@ set<std::size_t> Constraint::findCandidateValue( const ConstraintRegion& cr, con
 	for( ConstraintRegion::const_iterator crIt = cr.begin(); crIt != cr.end(); ++crIt )
 	{
 		const Cell::CandidateContainer& currentCandidates = (*crIt)->candidates();
-		if( find(currentCandidates.begin(), currentCandidates.end(), candidateValue) != currentCandidates.end() )
+		if( currentCandidates.contains( candidateValue ) )
 		{
 			indexes.insert( (*crIt)->index(indexType) );
 		}
@@ -175,17 +183,8 @@ bool Constraint::eliminate( ConstraintRegion& cr
 		//cout << "Examining cell index " << (*crIt)->index() << " with preserve region index " << (*crIt)->index(preserveRegionType) << endl;
 		if( find( preserveIndexes.begin(), preserveIndexes.end(), (*crIt)->index(preserveRegionType) ) == preserveIndexes.end() )
 		{
-			const std::size_t candidateSizeBeforeRemoval = (*crIt)->candidates().size();
-			(*crIt)->candidates().remove(candidateValue);
-			
-			if((*crIt)->candidates().empty())
-			{
-				std::cout << "Uh oh.  Constraint::eliminate has eliminated " << candidateValue << " from cell " << (*crIt)->index()  
-				          << ".  This cell now contains no candidates." << std::endl;
-				throw;  // FIXME throw an actual error.
-			} 
-			
-			if( candidateSizeBeforeRemoval > (*crIt)->candidates().size() )
+			// A cell left with no candidates is a contradiction, which its grid notes (see Grid::candidatesChanged)
+			if( (*crIt)->remove(candidateValue) )
 			{
 				//cout << "Removing " << candidateValue << " from cell at ";
 				//(*crIt)->writeCellLocationInformation( cout ) << endl;
@@ -210,17 +209,8 @@ bool Constraint::eliminate( ConstraintRegion& cr
 		//cout << "Examining cell index " << (*crIt)->index() << endl;
 		if( find( preserveCells.begin(), preserveCells.end(), *crIt ) == preserveCells.end() )
 		{
-			const std::size_t candidateSizeBeforeRemoval = (*crIt)->candidates().size();
-			(*crIt)->candidates().remove(candidateValue);
-			
-			if((*crIt)->candidates().empty())
-			{
-				std::cout << "Uh oh.  Constraint::eliminate has eliminated " << candidateValue << " from cell " << (*crIt)->index()  
-				<< ".  This cell now contains no candidates." << std::endl;
-				throw;  // FIXME throw an actual error.
-			} 
-			
-			if( candidateSizeBeforeRemoval > (*crIt)->candidates().size() )
+			// A cell left with no candidates is a contradiction, which its grid notes (see Grid::candidatesChanged)
+			if( (*crIt)->remove(candidateValue) )
 			{
 				//cout << "Removing " << candidateValue << " from cell at ";
 				//(*crIt)->writeCellLocationInformation( cout ) << endl;
@@ -233,7 +223,8 @@ bool Constraint::eliminate( ConstraintRegion& cr
 }
 
 
-bool Constraint::eliminate( const Cell* const pCell
+bool Constraint::eliminate( const Grid& grid
+                          , const Cell* const pCell
 			              , ConstraintRegion& box
 			              , const char candidateValue
 			              , const string& explanationFinish
@@ -245,14 +236,13 @@ bool Constraint::eliminate( const Cell* const pCell
 	bool didWork = false;
 	for( ConstraintRegion::iterator crIt = box.begin(); crIt != box.end(); ++crIt )
 	{
-		if( ((*crIt)->column() == pCell->column() || (*crIt)->row() == pCell->row())
+		if( grid.arePeers( **crIt, *pCell )
 			&& find( preserveCells.begin(), preserveCells.end(), *crIt ) == preserveCells.end() )
 		{
-			Cell::CandidateContainer::iterator candidateIt = find((*crIt)->candidates().begin(), (*crIt)->candidates().end(), candidateValue);
-			if( candidateIt != (*crIt)->candidates().end() )
+			if( (*crIt)->candidates().contains( candidateValue ) )
 			{
 				assert( (*crIt)->candidates().size() >= 2 );
-				(*crIt)->candidates().erase( candidateIt );
+				(*crIt)->remove( candidateValue );
 				changedCells.insert( *crIt );
 				// TODO: insert whole chain into explanatory cells
 				
@@ -275,8 +265,7 @@ vector< Cell* > Constraint::findCellsContainingCandidateValue( const ConstraintR
 	
 	for( ConstraintRegion::const_iterator crIt = cr.begin(); crIt != cr.end(); ++crIt )
 	{
-		const Cell::CandidateContainer& currentCandidates = (*crIt)->candidates();
-		if( find( (*crIt)->candidates().begin(), (*crIt)->candidates().end(), candidateValue ) != currentCandidates.end() )
+		if( (*crIt)->candidates().contains( candidateValue ) )
 		{
 			pointorsToCellsWithCandidateValue.push_back(*crIt);
 		}
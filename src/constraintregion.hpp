@@ -13,11 +13,14 @@ using std::set;
 #include <string>
 using std::string;
 
+#include "candidateset.hpp"
+
 
 namespace Sudoku {
 
-/// Forward declaration
+/// Forward declarations
 class Cell;
+struct Grid;
 
 
 /** A ConstraintRegion is any collection of 9 Cells.
@@ -37,9 +40,9 @@ struct PrintCellLocationInformation
 /** This struct contains all the functions that would normally be contained in the ConstraintRegion class */
 struct Constraint
 {
-	enum Type { row=0, column, square, grid };		
+	enum Type { row=0, column, square, grid, extra };   // extra is any other region of a variant (see ExtraRegions)
 	
-	/// Is the constraint region a row, column or square?
+	/// Is the constraint region a row, column or square (or an extra region if it is none of them)?
 	static Type calculateType( const ConstraintRegion& cr );
 	
 	/// If the constraint type is a row then return a column (and vice versa).  Undefined for squares or grid.
@@ -48,11 +51,12 @@ struct Constraint
 	/// Return the string representation of the type
 	static string typeToStr( const Constraint::Type type );
 	
-	/// If the constraint region is a row then return the row number.  Similarly for columns and squares. Undefined for grid.
+	/// If the constraint region is a row then return the row number.  Similarly for columns and squares.  For an extra region 
+	/// (which isn't numbered) it is the index of its first cell.  Undefined for grid.
 	static std::size_t calculateConstantIndex( const ConstraintRegion& cr );	
 	
-	/// Return a frequency table of the candidates in the given constraint region	
-	static vector<std::size_t> buildCandidateFrequencyTable( const ConstraintRegion& cr );
+	/// Count how many times each candidate appears in the given constraint region
+	static CandidateCounts countCandidates( const ConstraintRegion& cr );
 	
 	/// Return a frequency table of the values in the given constraint region	
 	static vector<std::size_t> buildValueFrequencyTable( const ConstraintRegion& cr );
@@ -76,8 +80,10 @@ struct Constraint
 						  , set<Cell*>& changedCells 
 						  , const set<Cell*>& preserveCells = set<Cell*>() );
 	
-	/// Eliminate the candidate value from any cell in the box that intersects with a row or column of the given cell
-	static bool eliminate( const Cell* const pCell
+	/// Eliminate the candidate value from any cell in the box that is a peer of the given cell (on its row or column, unless
+	/// the grid has other regions)
+	static bool eliminate( const Grid& grid
+	                     , const Cell* const pCell
 						 , ConstraintRegion& box
 				         , const char candidateValue
 						 , const string& explanationFinish
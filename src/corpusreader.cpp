@@ -0,0 +1,318 @@
+/*
+ *  corpusreader.cpp
+ *
+ */
+
+#include "corpusreader.hpp"
+#include "puzzleformat.hpp"
+using namespace Sudoku;
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <dirent.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedFile::MappedFile()
+	: begin_(0)
+	, end_(0)
+{}
+
+MappedFile::MappedFile( const string& filename )
+	: begin_(0)
+	, end_(0)
+{
+	open( filename );
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+void MappedFile::open( const string& filename )
+{
+	close();
+	
+	const int fd = ::open( filename.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		throw std::runtime_error( "Unable to open " + filename );
+	}
+	
+	struct stat status;
+	if( fstat( fd, &status ) != 0 )
+	{
+		::close( fd );
+		throw std::runtime_error( "Unable to stat " + filename );
+	}
+	
+	// An empty file can't be mapped but it is a perfectly good (empty) file
+	if( status.st_size > 0 )
+	{
+		void* map = mmap( 0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if( map == MAP_FAILED )
+		{
+			::close( fd );
+			throw std::runtime_error( "Unable to map " + filename );
+		}
+		madvise( map, status.st_size, MADV_SEQUENTIAL );
+		begin_ = static_cast<const char*>( map );
+		end_ = begin_ + status.st_size;
+	}
+	::close( fd );  // The mapping stays valid after the descriptor is closed
+}
+
+void MappedFile::close()
+{
+	if( begin_ )
+	{
+		munmap( const_cast<char*>( begin_ ), size() );
+	}
+	begin_ = 0;
+	end_ = 0;
+}
+
+
+CorpusReader::CorpusReader( const string& filename, const Format format )
+	: file_( filename )
+	, format_( format == automatic ? formatFromFilename( filename ) : format )
+	, pos_( file_.begin() )
+{
+	if( format_ == binary )
+	{
+		if( file_.size() != 0 && !isBinaryHeader( file_.begin(), file_.size() ) )
+		{
+			throw std::runtime_error( filename + " is not a binary puzzle file" );
+		}
+		pos_ = firstRecord();
+	}
+}
+
+const char* CorpusReader::firstRecord() const
+{
+	return ( file_.size() < binaryHeaderSize ) ? file_.end() : file_.begin() + binaryHeaderSize;
+}
+
+std::size_t CorpusReader::size() const
+{
+	if( format_ != binary ) { throw std::logic_error( "Only binary puzzle files have a known size" ); }
+	return ( file_.end() - firstRecord() ) / binaryRecordSize;
+}
+
+void CorpusReader::seek( const std::size_t puzzleNumber )
+{
+	if( format_ != binary ) { throw std::logic_error( "Only binary puzzle files can seek" ); }
+	pos_ = ( puzzleNumber < size() ) ? firstRecord() + puzzleNumber * binaryRecordSize : file_.end();
+}
+
+CorpusReader::Format CorpusReader::formatFromFilename( const string& filename )
+{
+	const string::size_type dot = filename.rfind( '.' );
+	const string extension = ( dot == string::npos ) ? string() : filename.substr( dot );
+	if( extension == ".csv" ) { return csv; }
+	if( extension == ".sdk" ) { return sdk; }
+	if( extension == ".sdb" ) { return binary; }
+	return line;
+}
+
+bool CorpusReader::next( char* givens )
+{
+	switch( format_ )
+	{
+		case line : return nextLine( givens ); break;
+		case sdk  : return nextSDK( givens );  break;
+		case csv  : return nextCSV( givens );  break;
+		case binary : return nextBinary( givens ); break;
+		default: throw std::runtime_error("Impossible corpus format");
+	}
+}
+
+const char* CorpusReader::takeLine()
+{
+	const char* lineEnd = static_cast<const char*>( std::memchr( pos_, '\n', file_.end() - pos_ ) );
+	if( lineEnd == 0 )
+	{
+		lineEnd = file_.end();
+		pos_ = file_.end();
+	}
+	else
+	{
+		pos_ = lineEnd + 1;
+	}
+	if( lineEnd != file_.begin() && *(lineEnd - 1) == '\r' )
+	{
+		--lineEnd;
+	}
+	return lineEnd;
+}
+
+bool CorpusReader::nextLine( char* givens )
+{
+	while( pos_ < file_.end() )
+	{
+		const char* lineStart = pos_;
+		const char* lineEnd = takeLine();
+		
+		// Allow for trailing white space after the puzzle
+		while( lineEnd != lineStart && ( *(lineEnd - 1) == ' ' || *(lineEnd - 1) == '\t' ) )
+		{
+			--lineEnd;
+		}
+		if( lineEnd - lineStart != 81 )
+		{
+			continue;  // Not a puzzle (perhaps a comment)
+		}
+		
+		std::size_t index = 0;
+		for( const char* it = lineStart; it != lineEnd; ++it, ++index )
+		{
+			if( *it >= '1' && *it <= '9' )
+			{
+				givens[index] = *it;
+			}
+			else if( *it == '0' || *it == '.' )
+			{
+				givens[index] = '0';
+			}
+			else
+			{
+				break;  // Not a puzzle
+			}
+		}
+		if( index == 81 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CorpusReader::nextSDK( char* givens )
+{
+	std::size_t index = 0;
+	bool skipping = false;  // Are we in a section (such as [State] or [PencilMarks]) that isn't part of the puzzle
+	
+	while( pos_ < file_.end() )
+	{
+		const char* lineStart = pos_;
+		const char* lineEnd = takeLine();
+		if( lineStart == lineEnd || *lineStart == '#' )
+		{
+			continue;
+		}
+		if( *lineStart == '[' )
+		{
+			static const char puzzleSection[] = "[Puzzle]";
+			skipping = !( lineEnd - lineStart >= 8 && std::memcmp( lineStart, puzzleSection, 8 ) == 0 );
+			index = 0;
+			continue;
+		}
+		if( skipping )
+		{
+			continue;
+		}
+		
+		for( const char* it = lineStart; it != lineEnd; ++it )
+		{
+			if( *it == ' ' || *it == '\t' )
+			{
+				continue;
+			}
+			givens[index++] = ( *it >= '1' && *it <= '9' ) ? *it : '0';
+			if( index == 81 )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool CorpusReader::nextCSV( char* givens )
+{
+	std::size_t index = 0;
+	while( pos_ < file_.end() && index < 81 )
+	{
+		const char* lineStart = pos_;
+		const char* lineEnd = takeLine();
+		
+		// Each ',' ends a value.  The final value on the line only counts if it isn't empty.
+		const char* valueStart = lineStart;
+		for( const char* it = lineStart; it <= lineEnd && index < 81; ++it )
+		{
+			if( it == lineEnd && it == valueStart )
+			{
+				break;
+			}
+			if( it == lineEnd || *it == ',' )
+			{
+				const char value = ( it == valueStart ) ? '0' : *valueStart;
+				givens[index++] = ( value >= '1' && value <= '9' ) ? value : '0';
+				valueStart = it + 1;
+			}
+		}
+	}
+	return index == 81;
+}
+
+bool CorpusReader::nextBinary( char* givens )
+{
+	if( file_.end() - pos_ < static_cast<std::ptrdiff_t>( binaryRecordSize ) )
+	{
+		return false;
+	}
+	unpackGrid( reinterpret_cast<const unsigned char*>( pos_ ), givens );
+	pos_ += binaryRecordSize;
+	return true;
+}
+
+bool Sudoku::isPuzzleFile( const string& filename )
+{
+	if( filename.find( ".solution." ) != string::npos ) { return false; }
+	const string::size_type dot = filename.rfind( '.' );
+	const string extension = ( dot == string::npos ) ? string() : filename.substr( dot );
+	return extension == ".sdk" || extension == ".csv" || extension == ".txt" || extension == ".sdb";
+}
+
+void Sudoku::findPuzzleFiles( const string& directory, vector<string>& filenames )
+{
+	DIR* dir = opendir( directory.c_str() );
+	if( !dir )
+	{
+		throw std::runtime_error( "Unable to open directory " + directory );
+	}
+	
+	vector<string> entries;
+	for( dirent* entry = readdir( dir ); entry; entry = readdir( dir ) )
+	{
+		const string name = entry->d_name;
+		if( name != "." && name != ".." )
+		{
+			entries.push_back( name );
+		}
+	}
+	closedir( dir );
+	std::sort( entries.begin(), entries.end() );
+	
+	for( vector<string>::const_iterator it = entries.begin(); it != entries.end(); ++it )
+	{
+		const string path = directory + "/" + *it;
+		DIR* subdirectory = opendir( path.c_str() );
+		if( subdirectory )
+		{
+			closedir( subdirectory );
+			findPuzzleFiles( path, filenames );
+		}
+		else if( isPuzzleFile( *it ) )
+		{
+			filenames.push_back( path );
+		}
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ *  corpusreader.hpp
+ *
+ */
+
+#ifndef CORPUSREADER_HPP_20261019
+#define CORPUSREADER_HPP_20261019
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+namespace Sudoku {
+
+/** A read-only memory mapping of a whole file */
+class MappedFile
+{
+public:
+	MappedFile();
+	explicit MappedFile( const string& filename );
+	~MappedFile();
+	
+	/// Map the given file (unmapping any previous file).  Throws std::runtime_error if the file can't be mapped.
+	void open( const string& filename );
+	void close();
+	
+	const char* begin() const { return begin_; }
+	const char* end() const   { return end_; }
+	std::size_t size() const  { return end_ - begin_; }
+
+private:
+	MappedFile( const MappedFile& );             // Not copyable
+	MappedFile& operator=( const MappedFile& );
+	
+	const char* begin_;
+	const char* end_;
+};
+
+
+/** Walk a file of puzzles in place, one puzzle at a time.  A corpus can be 
+ *  - lines of 81 characters (one puzzle per line, other lines are ignored), 
+ *  - SDK blocks (nine lines of nine characters, '#' comment lines and any section other than [Puzzle] are ignored), or
+ *  - CSV blocks (nine lines of nine comma separated values, 0 or empty for a cell without a given), or
+ *  - binary records (see puzzleformat.hpp).
+ *  Any number of puzzles can be in the one file.
+ */
+class CorpusReader
+{
+public:
+	enum Format { automatic, line, sdk, csv, binary };
+	
+	/// Map the file.  The automatic format uses the file extension: ".csv" is csv, ".sdk" is sdk, ".sdb" is binary, anything else is line.
+	explicit CorpusReader( const string& filename, const Format format = automatic );
+	
+	/// Write the next puzzle into givens as 81 characters, using '0' for an empty cell.  Returns false when there are no more puzzles.
+	bool next( char* givens );
+	
+	Format format() const { return format_; }
+	
+	/// The number of puzzles in a binary file.  Only binary files have fixed size records so this throws std::logic_error for the other formats.
+	std::size_t size() const;
+	
+	/// Make the given puzzle of a binary file the next one to be read.  Throws std::logic_error for the other formats.
+	void seek( const std::size_t puzzleNumber );
+	
+	/// Deduce the format from the file extension
+	static Format formatFromFilename( const string& filename );
+
+private:
+	bool nextLine( char* givens );
+	bool nextSDK( char* givens );
+	bool nextCSV( char* givens );
+	bool nextBinary( char* givens );
+	const char* firstRecord() const;
+	
+	/// Return the end of the line starting at pos_ (excluding any '\r') and move pos_ onto the start of the following line
+	const char* takeLine();
+	
+	MappedFile file_;
+	Format format_;
+	const char* pos_;
+};
+
+
+/// True if the file holds puzzles (.sdk, .csv, .txt or .sdb) rather than solutions (.solution.csv)
+bool isPuzzleFile( const string& filename );
+
+/// Append the puzzle files below the directory (recursively, in a repeatable order) to filenames.  Throws std::runtime_error if the directory can't be opened.
+void findPuzzleFiles( const string& directory, vector<string>& filenames );
+
+} // namespace Sudoku
+
+#endif // CORPUSREADER_HPP_20261019
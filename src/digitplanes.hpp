@@ -0,0 +1,172 @@
+/*
+ *  digitplanes.hpp
+ *
+ */
+
+#ifndef DIGITPLANES_HPP_20261019
+#define DIGITPLANES_HPP_20261019
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "gridgeometry.hpp"
+#include "candidateset.hpp"
+#include "constraintregion.hpp"
+#include "grid.hpp"
+
+namespace Sudoku {
+
+/// A set of cells of the grid, one bit per cell index
+struct CellBits
+{
+	CellBits() : low(0), high(0) {}
+
+	void set( const std::size_t index ) { if( index < 64 ) { low |= uint64_t(1) << index; } else { high |= uint64_t(1) << ( index - 64 ); } }
+	void reset( const std::size_t index ) { if( index < 64 ) { low &= ~( uint64_t(1) << index ); } else { high &= ~( uint64_t(1) << ( index - 64 ) ); } }
+
+	bool any() const { return ( low | high ) != 0; }
+	bool contains( const std::size_t index ) const { return index < 64 ? ( low >> index ) & 1 : ( high >> ( index - 64 ) ) & 1; }
+
+	/// More than one cell in the set
+	bool several() const { return ( low & ( low - 1 ) ) || ( high & ( high - 1 ) ) || ( low && high ); }
+
+	/// The lowest cell index in the set, which mustn't be empty
+	std::size_t first() const { return low ? __builtin_ctzll( low ) : 64 + __builtin_ctzll( high ); }
+
+	CellBits operator&( const CellBits& other ) const { return CellBits( low & other.low, high & other.high ); }
+	CellBits operator|( const CellBits& other ) const { return CellBits( low | other.low, high | other.high ); }
+	CellBits operator~() const { return CellBits( ~low, ~high ); }
+
+	uint64_t low;    ///< Cells 0-63
+	uint64_t high;   ///< Cells 64-80
+
+private:
+	CellBits( const uint64_t lowBits, const uint64_t highBits ) : low( lowBits ), high( highBits ) {}
+};
+
+
+/** The candidates of the grid turned on their side: for each digit, the set of cells that still have it as a candidate.
+ *  This makes the question IntersectReject asks ("are all the places for this digit in the region inside one intersection
+ *  with another region, and does that other region have the digit anywhere else?") a couple of mask tests per digit.
+ *
+ *  The planes are a copy, so whoever removes candidates from the grid has to remove them here too to keep them in step.
+ */
+class DigitPlanes
+{
+public:
+	DigitPlanes() : loaded_( false ) {}
+
+	bool loaded() const { return loaded_; }
+
+	void load( const Grid& grid )
+	{
+		for( std::size_t digit = 0; digit != 9; ++digit ) { planes_[digit] = CellBits(); }
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			for( CandidateSet::Mask mask = grid.cells[index].candidates().mask(); mask; mask &= mask - 1 )
+			{
+				planes_[__builtin_ctz( mask )].set( index );
+			}
+		}
+		loaded_ = true;
+	}
+
+	void remove( const std::size_t index, const char value ) { planes_[value - '1'].reset( index ); }
+
+	/** The digits (bit d-1 for the digit d) that are in at least two cells of the region and only in its intersection with
+	    one other region (a square for a row or column and a row or column for a square), where that other region still has
+	    the digit outside the intersection.  These are the digits for which IntersectReject will eliminate something.
+	*/
+	CandidateSet::Mask intersections( const Constraint::Type type, const std::size_t index ) const
+	{
+		const Shapes& shapes = Shapes::instance();
+		const std::size_t region = 9 * type + index;
+		const std::size_t numberOfSegments = type == Constraint::square ? 6 : 3;
+
+		CandidateSet::Mask digits = 0;
+		for( std::size_t digit = 0; digit != 9; ++digit )
+		{
+			const CellBits inRegion = planes_[digit] & shapes.regions[region];
+			if( !inRegion.several() )
+			{
+				continue;
+			}
+			for( std::size_t segment = 0; segment != numberOfSegments; ++segment )
+			{
+				const Shapes::Segment& shape = shapes.segments[region][segment];
+				if( !( inRegion & ~shape.cells ).any() && ( planes_[digit] & shape.rest ).any() )
+				{
+					digits |= static_cast<CandidateSet::Mask>( 1u << digit );
+					break;
+				}
+			}
+		}
+		return digits;
+	}
+
+private:
+	/// The cells of each region (rows, then columns, then squares as in GridGeometry) and of the intersections they take part in
+	struct Shapes
+	{
+		struct Segment
+		{
+			CellBits cells;   ///< Where the region meets the other region
+			CellBits rest;    ///< The rest of the other region
+		};
+
+		static const Shapes& instance()
+		{
+			static const Shapes shapes;
+			return shapes;
+		}
+
+		CellBits regions[27];
+		Segment segments[27][6];   ///< The three squares a row or column crosses, or the three rows and three columns of a square
+
+	private:
+		Shapes()
+		{
+			const GridGeometry& geometry = GridGeometry::instance();
+			for( std::size_t region = 0; region != 27; ++region )
+			{
+				for( std::size_t position = 0; position != 9; ++position ) { regions[region].set( geometry.regions[region][position] ); }
+			}
+
+			std::size_t lineSegments[18] = {};
+			for( std::size_t square = 0; square != 9; ++square )
+			{
+				for( std::size_t line = 0; line != 6; ++line )
+				{
+					const GridGeometry::Intersection& intersection = geometry.intersections[6 * square + line];
+					CellBits cells;
+					CellBits restOfSquare;
+					CellBits restOfLine;
+					for( std::size_t cell = 0; cell != 3; ++cell ) { cells.set( intersection.segment[cell] ); }
+					for( std::size_t cell = 0; cell != 6; ++cell )
+					{
+						restOfSquare.set( intersection.restOfSquare[cell] );
+						restOfLine.set( intersection.restOfLine[cell] );
+					}
+
+					// Pointing, seen from the square: confined to the line so the rest of the line loses the digit
+					segments[18 + square][line].cells = cells;
+					segments[18 + square][line].rest = restOfLine;
+
+					// Claiming, seen from the line: confined to the square so the rest of the square loses the digit
+					const std::size_t lineRegion = line < 3 ? intersection.segment[0] / 9 : 9 + intersection.segment[0] % 9;
+					Segment& fromLine = segments[lineRegion][lineSegments[lineRegion]++];
+					fromLine.cells = cells;
+					fromLine.rest = restOfSquare;
+				}
+			}
+		}
+	};
+
+	CellBits planes_[9];
+	bool loaded_;
+};
+
+} // namespace Sudoku
+
+#endif // DIGITPLANES_HPP_20261019
@@ -0,0 +1,149 @@
+/*
+ *  extraregions.hpp
+ *
+ */
+
+#ifndef EXTRAREGIONS_HPP_20261019
+#define EXTRAREGIONS_HPP_20261019
+
+#include <cstdlib>
+#include <cstddef>
+
+#include <algorithm>
+
+#include <fstream>
+using std::ifstream;
+
+#include <sstream>
+using std::istringstream;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+namespace Sudoku {
+
+/** Regions that a variant puzzle has on top of the rows, columns and squares: nine cells that must also hold each digit
+ *  once, such as the two diagonals of an X sudoku or the four windows of a windoku.  A jigsaw has irregular regions in 
+ *  place of the squares instead.  Each region is its nine cell indexes (0 to 80).  See Grid::addRegions.
+ */
+struct ExtraRegions
+{
+	bool empty() const { return regions.empty() && squares.empty(); }
+
+	/// Add a region.  It must be nine different cells of the grid.
+	void add( const vector<std::size_t>& cells )
+	{
+		vector<std::size_t> sorted( cells );
+		std::sort( sorted.begin(), sorted.end() );
+		if( sorted.size() != 9 || sorted.back() > 80 || std::adjacent_find( sorted.begin(), sorted.end() ) != sorted.end() )
+		{
+			throw std::runtime_error( "An extra region must be nine different cells from 0 to 80" );
+		}
+		regions.push_back( cells );
+	}
+
+	/// Put these nine regions in place of the squares (a jigsaw).  Between them they must have every cell of the grid once.
+	void replaceSquares( const vector< vector<std::size_t> >& jigsaw )
+	{
+		vector<std::size_t> cells;
+		for( vector< vector<std::size_t> >::const_iterator it = jigsaw.begin(); it != jigsaw.end(); ++it )
+		{
+			ExtraRegions region;
+			region.add( *it );
+			cells.insert( cells.end(), it->begin(), it->end() );
+		}
+		std::sort( cells.begin(), cells.end() );
+		if( jigsaw.size() != 9 || std::adjacent_find( cells.begin(), cells.end() ) != cells.end() )
+		{
+			throw std::runtime_error( "A jigsaw must be nine regions that have every cell once" );
+		}
+		squares = jigsaw;
+	}
+
+	/// The two long diagonals (X sudoku)
+	void addDiagonals()
+	{
+		vector<std::size_t> down;
+		vector<std::size_t> up;
+		for( std::size_t loop = 0; loop != 9; ++loop )
+		{
+			down.push_back( 10 * loop );
+			up.push_back( 8 * ( loop + 1 ) );
+		}
+		add( down );
+		add( up );
+	}
+
+	/// The four 3x3 windows whose top left cells are at rows and columns 1 and 5 (windoku)
+	void addWindows()
+	{
+		const std::size_t corners[4] = { 10, 14, 50, 54 };
+		for( std::size_t window = 0; window != 4; ++window )
+		{
+			vector<std::size_t> cells;
+			for( std::size_t position = 0; position != 9; ++position ) { cells.push_back( corners[window] + 9 * ( position / 3 ) + position % 3 ); }
+			add( cells );
+		}
+	}
+
+	/** Add the regions described: "x" for the diagonals, "windoku" for the windows, "jigsaw:" followed by the name of a
+	    file with the nine regions to put in place of the squares, or otherwise the name of a file of regions to add.  A file
+	    has a region per line, given as nine cell indexes separated by spaces or commas.  Blank lines and lines starting 
+	    with '#' are skipped.
+	*/
+	void parse( const string& description )
+	{
+		if( description == "x" )       { addDiagonals(); return; }
+		if( description == "windoku" ) { addWindows(); return; }
+		if( description.compare( 0, 7, "jigsaw:" ) == 0 )
+		{
+			ExtraRegions jigsaw;
+			jigsaw.read( description.substr( 7 ) );
+			replaceSquares( jigsaw.regions );
+			return;
+		}
+		read( description );
+	}
+
+	vector< vector<std::size_t> > regions;
+	vector< vector<std::size_t> > squares;  // The regions of a jigsaw, if the squares are replaced (otherwise empty)
+
+private:
+	/// Add the regions in a file
+	void read( const string& description )
+	{
+		ifstream fin( description.c_str() );
+		if( !fin )
+		{
+			throw std::runtime_error( "Unable to open the region file " + description );
+		}
+		string line;
+		while( std::getline( fin, line ) )
+		{
+			std::replace( line.begin(), line.end(), ',', ' ' );
+			if( line.find_first_not_of( " \t\r" ) == string::npos || line[line.find_first_not_of( " \t\r" )] == '#' )
+			{
+				continue;
+			}
+			istringstream iss( line );
+			vector<std::size_t> cells;
+			string cell;
+			while( iss >> cell )
+			{
+				char* end = 0;
+				cells.push_back( std::strtoul( cell.c_str(), &end, 10 ) );
+				if( *end != '\0' ) { throw std::runtime_error( "Not a cell index in " + description + ": " + cell ); }
+			}
+			add( cells );
+		}
+	}
+};
+
+} // namespace Sudoku
+
+#endif // EXTRAREGIONS_HPP_20261019
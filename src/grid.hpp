@@ -3,6 +3,10 @@
 
 #include "cell.hpp"
 #include "constraintregion.hpp"
+#include "corpusreader.hpp"
+#include "extraregions.hpp"
+#include "puzzleformat.hpp"
+#include "ruleusage.hpp"
 
 #include <iosfwd> 
 using std::ostream;
@@ -13,6 +17,9 @@ using std::string;
 #include <vector>
 using std::vector;
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <fstream>
 using std::ifstream;
 using std::ofstream;
@@ -28,12 +35,17 @@ struct Grid
         , rows(9)
         , columns(9)
         , squares(9)
+        , solvedCells(0)
+        , contradiction(false)
+        , jigsaw(false)
     {
+    	std::fill( stalledAt, stalledAt + RuleUsage::numberOfRules, 0 );
+
     	// Allocate all the cells
 		cells.reserve(81);
     	for( std::size_t index = 0; index != 81; ++index )
     	{
-    		cells.push_back(Cell(index));
+    		cells.push_back(Cell(index, this));
     	}
 
     	// Allocate some memory for the rows, columns, squares (since a constraint region is only a typedef and not a real class)
@@ -76,93 +88,317 @@ struct Grid
             	currentSq[cellIndex]  = &cells[squareCellIndex];
             }
         }
+        
+        buildPeers();
     }
 	
-	void parse( const string& filename )
+	/** Add the regions of a variant to the rows, columns and squares (or, for a jigsaw, put its regions in place of the 
+	    squares).  All the rules then use them too: the region rules directly and the rest through the peers and the regions
+	    of each cell.
+	*/
+	void addRegions( const ExtraRegions& regions )
 	{
-		if( *filename.rbegin() == 'v' )
+		if( !regions.squares.empty() )
 		{
-			parseCSV( filename );			
+			for( std::size_t square = 0; square != 9; ++square )
+			{
+				for( std::size_t position = 0; position != 9; ++position )
+				{
+					Cell& cell = cells[regions.squares[square][position]];
+					cell.square( square );
+					squares[square][position] = &cell;
+				}
+			}
+			jigsaw = true;
 		}
-		else if( *filename.rbegin() == 'k' )
+		for( vector< vector<std::size_t> >::const_iterator it = regions.regions.begin(); it != regions.regions.end(); ++it )
 		{
-			parseSDK( filename );
+			ConstraintRegion region;
+			for( vector<std::size_t>::const_iterator cellIt = it->begin(); cellIt != it->end(); ++cellIt )
+			{
+				region.push_back( &cells[*cellIt] );
+			}
+			extras.push_back( region );
 		}
-		else throw "Unparsable file format";
+		buildPeers();
 	}
 	
-	void parseSDK( const string& filename )
+	/// Forget the current puzzle so that the grid can be reused
+	void reset()
 	{
-		ifstream ifs( filename.c_str() );
-		std::string line;
-		std::size_t index = 0;
-		
-		// Extract a single line from the file
-		while( getline( ifs,line ) && index < 81 ) 
-		{	
-			if( *line.begin() == '#' || *line.begin() == '[' ) 
+		for( vector<Cell>::iterator it = cells.begin(); it != cells.end(); ++it )
+		{
+			it->reset();
+		}
+		solvedCells = 0;
+		std::fill( stalledAt, stalledAt + RuleUsage::numberOfRules, 0 );
+		std::fill( placed.begin(), placed.end(), 0 );
+		std::fill( spots.begin(), spots.end(), 9 );  // Every region has 9 cells
+		contradiction = false;
+	}
+	
+	/** Whether the grid holds a complete solution, known without a consistency check: every cell has one candidate left and
+	    every digit still has a cell in every region, so each region has each digit exactly once.  Both are counted as the
+	    candidates change, so it is cheap enough to ask before every rule.
+	*/
+	bool solved() const
+	{
+		return solvedCells == cells.size() && !contradiction;
+	}
+	
+	/** Called by a cell of this grid whenever its candidates change, to keep solvedCells and spots up to date.  A cell that
+	    loses its last candidate, or a digit that loses its last cell in a region, sets contradiction there and then.
+	*/
+	void candidatesChanged( const Cell& cell, const CandidateSet::Mask before )
+	{
+		const CandidateSet::Mask after = cell.candidates().mask();
+		const CandidateSet::Mask removed = before & ~after;
+		const CandidateSet::Mask added = after & ~before;
+		const vector<std::size_t>& regions = regionsOfCell[cell.index()];
+		for( vector<std::size_t>::const_iterator it = regions.begin(); it != regions.end(); ++it )
+		{
+			unsigned char* regionSpots = &spots[9 * *it];
+			for( CandidateSet::Mask bits = removed; bits; bits &= bits - 1 )
 			{
-				continue;
+				if( --regionSpots[__builtin_ctz( bits )] == 0 ) { contradiction = true; }
 			}
-			
-			for( std::string::const_iterator it = line.begin(); it != line.end(); ++it )
+			for( CandidateSet::Mask bits = added; bits; bits &= bits - 1 )
 			{
-				if( *it == '\r' || *it == ' ' || *it == '\t' )
-				{
-					continue;
-				}
-				if( *it != '.'  )
-				{
-					cells[index++].initial( *it );		
-				}
-				else
-				{
-					++index;
-				}				
+				++regionSpots[__builtin_ctz( bits )];
 			}
-		}		
+		}
+		
+		const bool wasSolved = before && !( before & ( before - 1 ) );
+		const bool isSolved = after && !( after & ( after - 1 ) );
+		if( wasSolved != isSolved ) { isSolved ? ++solvedCells : --solvedCells; }
+		if( !after ) { contradiction = true; }
 	}
-
-	void parseCSV( const string& filename )
+	
+	/** Check every region with a mask rather than an Inconsistency sweep.  Returns false if a value is in two cells of a region, 
+	    a cell has no candidates left or a digit has no cell left in a region, and, if complete, if any cell isn't solved.
+	*/
+	bool consistent( const bool complete = false ) const
 	{
-		ifstream ifs( filename.c_str() );
-		std::string line;
-		std::size_t index = 0;
-		
-		// Extract a single line from the file
-		while( getline( ifs,line ) && index < 81 ) 
-		{		
-			// Extract the ',' delimited elements from the file
-			istringstream iss(line);
-			std::string element;
-			
-			while( getline( iss, element, ',' ) )
+		const Constraint::Type types[] = { Constraint::row, Constraint::column, Constraint::square, Constraint::extra };
+		for( std::size_t type = 0; type != sizeof(types) / sizeof(types[0]); ++type )
+		{
+			const vector<ConstraintRegion>& regions = get( types[type] );
+			for( vector<ConstraintRegion>::const_iterator it = regions.begin(); it != regions.end(); ++it )
 			{
-				if( !element.empty() && !(element[0]=='0') )
+				CandidateSet::Mask values = 0;
+				CandidateSet::Mask possible = 0;
+				for( ConstraintRegion::const_iterator cellIt = it->begin(); cellIt != it->end(); ++cellIt )
 				{
-					cells[index++].initial( element[0] );		
+					const CandidateSet::Mask mask = (*cellIt)->candidates().mask();
+					const bool single = mask && !( mask & ( mask - 1 ) );
+					if( !mask || ( single && ( values & mask ) ) || ( complete && !single ) )
+					{
+						return false;
+					}
+					values |= single ? mask : 0;
+					possible |= mask;
 				}
-				else
+				if( possible != CandidateSet::allDigits )
 				{
-					++index;
+					return false;
 				}
 			}
 		}
+		return true;
 	}
 	
-	void writeCSV( const string& filename )
+	/// Whether the grid has only the rows, columns and 3x3 squares, which some rules have faster ways of their own to search
+	bool regular() const { return extras.empty() && !jigsaw; }
+	
+	/// Whether the region with this number is one that only a variant has: an extra region or a square of a jigsaw
+	bool irregular( const std::size_t number ) const { return number >= 27 || ( jigsaw && number >= 18 ); }
+	
+	/// The region with this number (numbered as in regionsOfCell)
+	ConstraintRegion& region( const std::size_t number )
 	{
-		ofstream fout( filename.c_str() );
-		for( std::size_t rowIndex = 0; rowIndex != 9; ++rowIndex )
+		return number < 27 ? get( static_cast<Constraint::Type>( number / 9 ) )[number % 9] : extras[number - 27];
+	}
+	
+	const ConstraintRegion& region( const std::size_t number ) const
+	{
+		return number < 27 ? get( static_cast<Constraint::Type>( number / 9 ) )[number % 9] : extras[number - 27];
+	}
+	
+	/// The type of the region with this number and its index among the regions of that type
+	static Constraint::Type regionType( const std::size_t number ) { return number < 27 ? static_cast<Constraint::Type>( number / 9 ) : Constraint::extra; }
+	static std::size_t regionIndex( const std::size_t number )     { return number < 27 ? number % 9 : number - 27; }
+	
+	/// The number of a region of this grid
+	std::size_t regionNumber( const ConstraintRegion& cr ) const
+	{
+		const Constraint::Type types[] = { Constraint::row, Constraint::column, Constraint::square, Constraint::extra };
+		for( std::size_t type = 0; type != sizeof(types) / sizeof(types[0]); ++type )
+		{
+			const vector<ConstraintRegion>& regions = get( types[type] );
+			if( !regions.empty() && &cr >= &regions.front() && &cr <= &regions.back() )
+			{
+				return 9 * type + ( &cr - &regions.front() );
+			}
+		}
+		throw std::runtime_error( "Not a region of this grid" );
+	}
+	
+	/// Whether two different cells share a region
+	bool arePeers( const Cell& first, const Cell& second ) const
+	{
+		const vector<Cell*>& firstPeers = peers[first.index()];
+		return std::binary_search( firstPeers.begin(), firstPeers.end(), &cells[second.index()] );
+	}
+	
+	/// Load a puzzle from 81 characters.  '1'-'9' are givens, anything else is an empty cell.
+	void load( const char* givens )
+	{
+		reset();
+		for( std::size_t index = 0; index != 81; ++index )
 		{
-			for( std::size_t colIndex = 0; colIndex != 8; ++colIndex )
+			if( givens[index] >= '1' && givens[index] <= '9' )
 			{
-				fout << rows[rowIndex][colIndex]->value() << ',';
+				cells[index].initial( givens[index] );
 			}
-			fout << rows[rowIndex][8]->value()<< '\n';
 		}
 	}
 	
+	/// Write the 81 initial values into givens, using '0' for the cells that weren't given
+	void givens( char* givens ) const
+	{
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			givens[index] = cells[index].initial() ? *cells[index].candidates().begin() : '0';
+		}
+	}
+	
+	/// Write the 81 current values into values, using '0' for the cells that aren't yet solved
+	void values( char* values ) const
+	{
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			const Cell::CandidateContainer& candidates = cells[index].candidates();
+			values[index] = ( !candidates.empty() && ++candidates.begin() == candidates.end() ) ? *candidates.begin() : '0';
+		}
+	}
+	
+	/** Write the candidates of every cell as 729 characters: nine per cell, with the digit if it is still a candidate and '.' if it isn't.
+	    This captures the whole state of a partially solved grid (the "pencil marks") rather than just the values.
+	*/
+	void candidates( char* candidateStates ) const
+	{
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			char* cellState = candidateStates + 9 * index;
+			std::fill( cellState, cellState + 9, '.' );
+			const Cell::CandidateContainer& cellCandidates = cells[index].candidates();
+			for( Cell::CandidateContainer::const_iterator it = cellCandidates.begin(); it != cellCandidates.end(); ++it )
+			{
+				cellState[*it - '1'] = *it;
+			}
+		}
+	}
+	
+	/// Restore the candidates of every cell from 729 characters written by candidates()
+	void loadCandidates( const char* candidateStates )
+	{
+		reset();
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			CandidateSet::Mask mask = 0;
+			for( std::size_t digit = 0; digit != 9; ++digit )
+			{
+				if( candidateStates[9 * index + digit] == '1' + static_cast<char>( digit ) )
+				{
+					mask |= CandidateSet::bit( '1' + static_cast<char>( digit ) );
+				}
+			}
+			cells[index].assign( mask );
+		}
+	}
+	
+	/// The total number of candidates left in all the cells
+	std::size_t candidateCount() const
+	{
+		std::size_t count = 0;
+		for( vector<Cell>::const_iterator it = cells.begin(); it != cells.end(); ++it )
+		{
+			count += it->candidates().size();
+		}
+		return count;
+	}
+	
+	/// Load the first puzzle in the given file.  The format is determined by the file extension (see CorpusReader).
+	void parse( const string& filename )
+	{
+		parse( filename, CorpusReader::automatic );
+	}
+	
+	void parseSDK( const string& filename )
+	{
+		parse( filename, CorpusReader::sdk );
+	}
+
+	void parseCSV( const string& filename )
+	{
+		parse( filename, CorpusReader::csv );
+	}
+	
+	void parse( const string& filename, const CorpusReader::Format format )
+	{
+		CorpusReader reader( filename, format );
+		char givens[81];
+		if( reader.next( givens ) )
+		{
+			load( givens );
+		}
+	}
+	
+	/// Write the current values to a file.  The format is determined by the file extension: ".sdb" is binary, anything else is CSV.
+	void write( const string& filename )
+	{
+		if( CorpusReader::formatFromFilename( filename ) == CorpusReader::binary )
+		{
+			writeBinary( filename );
+		}
+		else
+		{
+			writeCSV( filename );
+		}
+	}
+	
+	/// Write a binary file (header and one record) holding the current values
+	void writeBinary( const string& filename )
+	{
+		ofstream fout( filename.c_str(), std::ios::binary );
+		char header[binaryHeaderSize];
+		fout.write( header, formatBinaryHeader( header ) );
+		writeBinary( fout );
+	}
+	
+	/// Append a single binary record of the current values (the stream must already have the binary header)
+	void writeBinary( ostream& os )
+	{
+		char currentValues[81];
+		values( currentValues );
+		char record[binaryRecordSize];
+		os.write( record, formatBinary( currentValues, record ) );
+	}
+	
+	void writeCSV( const string& filename )
+	{
+		ofstream fout( filename.c_str() );
+		writeCSV( fout );
+	}
+	
+	void writeCSV( ostream& os )
+	{
+		char currentValues[81];
+		values( currentValues );
+		char block[maxFormattedSize];
+		os.write( block, formatCSV( currentValues, block ) );
+	}
+	
 	vector<ConstraintRegion>& get( const Constraint::Type type )
 	{
 		switch( type )
@@ -176,6 +412,9 @@ struct Grid
 			case Constraint::square:
 				return squares;
 				break;
+			case Constraint::extra:
+				return extras;
+				break;
 			default:
 				throw;
 				break;
@@ -195,6 +434,9 @@ struct Grid
 			case Constraint::square:
 				return squares;
 				break;
+			case Constraint::extra:
+				return extras;
+				break;
 			default:
 				throw;
 				break;
@@ -218,10 +460,86 @@ struct Grid
     vector<ConstraintRegion> rows;
     vector<ConstraintRegion> columns;
     vector<ConstraintRegion> squares;
+    vector<ConstraintRegion> extras;   // Any other regions of a variant puzzle (see addRegions)
+    vector< vector<Cell*> > peers;     // For each cell, the other cells that share a region with it (in the order of the cells)
+    std::size_t solvedCells;           // How many cells have a single candidate left
+    std::size_t stalledAt[RuleUsage::numberOfRules];  // For each rule, the candidateCount() when it last made no progress (0 if it hasn't failed)
+    vector< vector<std::size_t> > regionsOfCell;  // For each cell, the regions it is in: rows are 0-8, columns 9-17, squares 18-26 and extras from 27
+    vector<CandidateSet::Mask> placed; // For each region (numbered as above), the values of the cells in it that have been propagated
+    vector<unsigned char> spots;       // For each region (numbered as above) and digit, how many of its cells still have the digit
+    bool contradiction;                // Set as soon as the candidates show that the puzzle has no solution
+    bool jigsaw;                       // The squares are the irregular regions of a jigsaw rather than 3x3 (see addRegions)
+	
+private:
+	Grid( const Grid& );               // The regions point into the cells so a copy would point into the original
+	Grid& operator=( const Grid& );
+	
+	/// Work out the peers of every cell from all the regions
+	void buildPeers()
+	{
+		vector< vector<bool> > isPeer( cells.size(), vector<bool>( cells.size(), false ) );
+		const Constraint::Type types[] = { Constraint::row, Constraint::column, Constraint::square, Constraint::extra };
+		for( std::size_t type = 0; type != sizeof(types) / sizeof(types[0]); ++type )
+		{
+			const vector<ConstraintRegion>& regions = get( types[type] );
+			for( vector<ConstraintRegion>::const_iterator it = regions.begin(); it != regions.end(); ++it )
+			{
+				for( ConstraintRegion::const_iterator first = it->begin(); first != it->end(); ++first )
+				{
+					for( ConstraintRegion::const_iterator second = it->begin(); second != it->end(); ++second )
+					{
+						isPeer[(*first)->index()][(*second)->index()] = first != second;
+					}
+				}
+			}
+		}
+		
+		peers.assign( cells.size(), vector<Cell*>() );
+		for( std::size_t index = 0; index != cells.size(); ++index )
+		{
+			for( std::size_t other = 0; other != cells.size(); ++other )
+			{
+				if( isPeer[index][other] ) { peers[index].push_back( &cells[other] ); }
+			}
+		}
+		
+		regionsOfCell.assign( cells.size(), vector<std::size_t>() );
+		std::size_t region = 0;
+		for( std::size_t type = 0; type != sizeof(types) / sizeof(types[0]); ++type )
+		{
+			const vector<ConstraintRegion>& regions = get( types[type] );
+			for( vector<ConstraintRegion>::const_iterator it = regions.begin(); it != regions.end(); ++it, ++region )
+			{
+				for( ConstraintRegion::const_iterator cellIt = it->begin(); cellIt != it->end(); ++cellIt )
+				{
+					regionsOfCell[(*cellIt)->index()].push_back( region );
+				}
+			}
+		}
+		placed.assign( region, 0 );
+		
+		// Count the candidates the cells already have, for regions added after a puzzle was loaded
+		spots.assign( 9 * region, 0 );
+		solvedCells = 0;
+		for( vector<Cell>::const_iterator it = cells.begin(); it != cells.end(); ++it )
+		{
+			candidatesChanged( *it, 0 );
+		}
+		contradiction = contradiction || std::find( spots.begin(), spots.end(), 0 ) != spots.end();
+	}
 };
 
 
-ostream& operator<<( ostream& os, const Grid& grid )
+inline void Cell::changed( const CandidateSet::Mask before )
+{
+	if( grid_ )
+	{
+		grid_->candidatesChanged( *this, before );
+	}
+}
+
+
+inline ostream& operator<<( ostream& os, const Grid& grid )
 {
 	for( std::size_t rowIndex = 0; rowIndex != 9; ++rowIndex )
 	{
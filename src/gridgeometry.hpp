@@ -0,0 +1,162 @@
+/*
+ *  gridgeometry.hpp
+ *
+ */
+
+#ifndef GRIDGEOMETRY_HPP_20261019
+#define GRIDGEOMETRY_HPP_20261019
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Sudoku {
+
+/** What depends on the order of the boxes (2 for a 4x4 grid, 3 for the usual 9x9 grid, 4 for 16x16 and 5 for 25x25):
+ *  the type of a mask with one bit per digit, the type that can hold a cell index and the characters used for the digits.
+ *  Nothing is defined for any other order, so using one fails to compile.
+ */
+template< std::size_t order > struct BoxTraits;
+
+template<> struct BoxTraits<2>
+{
+	typedef uint16_t Mask;
+	typedef unsigned char Index;
+	static const char* symbols() { return "1234"; }
+};
+
+template<> struct BoxTraits<3>
+{
+	typedef uint16_t Mask;
+	typedef unsigned char Index;
+	static const char* symbols() { return "123456789"; }
+};
+
+template<> struct BoxTraits<4>
+{
+	typedef uint16_t Mask;
+	typedef unsigned char Index;
+	static const char* symbols() { return "123456789ABCDEFG"; }
+};
+
+template<> struct BoxTraits<5>
+{
+	typedef uint32_t Mask;
+	typedef uint16_t Index;
+	static const char* symbols() { return "ABCDEFGHIJKLMNOPQRSTUVWXY"; }
+};
+
+
+/** The shape of a grid of boxes of the given order as index tables: the cells of each region (rows, then columns, then
+ *  squares), the peers of each cell (the other cells that share a row, column or square with it) and the places where a
+ *  square meets one of its rows or columns.  Built once per order and shared.
+ */
+template< std::size_t order >
+struct BoxGeometry
+{
+	typedef typename BoxTraits<order>::Index Index;
+	typedef typename BoxTraits<order>::Mask Mask;
+
+	static const std::size_t size = order * order;                                      ///< Digits, and cells in a region
+	static const std::size_t numberOfCells = size * size;
+	static const std::size_t numberOfRegions = 3 * size;
+	static const std::size_t numberOfPeers = 2 * ( size - 1 ) + ( order - 1 ) * ( order - 1 );
+	static const std::size_t numberOfIntersections = 2 * order * size;
+	static const Mask allDigits = static_cast<Mask>( ( uint64_t(1) << size ) - 1 );
+
+	static const BoxGeometry& instance()
+	{
+		static const BoxGeometry geometry;
+		return geometry;
+	}
+
+	/// The digit (0 to size-1) written as the character, or -1 for an empty cell or any character that isn't a digit
+	static int digit( const char symbol )
+	{
+		const char upper = ( symbol >= 'a' && symbol <= 'z' ) ? static_cast<char>( symbol - 'a' + 'A' ) : symbol;
+		const char* symbols = BoxTraits<order>::symbols();
+		for( std::size_t digit = 0; digit != size; ++digit )
+		{
+			if( symbols[digit] == upper ) { return static_cast<int>( digit ); }
+		}
+		return -1;
+	}
+
+	static char symbol( const std::size_t digit ) { return BoxTraits<order>::symbols()[digit]; }
+
+	/// The order cells that a square shares with a line (row or column) and the other cells of each
+	struct Intersection
+	{
+		Index segment[order];
+		Index restOfSquare[size - order];
+		Index restOfLine[size - order];
+	};
+
+	Index regions[numberOfRegions][size];
+	Index peers[numberOfCells][numberOfPeers];
+	Intersection intersections[numberOfIntersections];  ///< For each square, its rows and then its columns
+
+private:
+	static std::size_t squareOf( const std::size_t index ) { return order * ( index / ( order * size ) ) + ( index % size ) / order; }
+
+	BoxGeometry()
+	{
+		for( std::size_t loop = 0; loop != size; ++loop )
+		{
+			for( std::size_t position = 0; position != size; ++position )
+			{
+				regions[loop][position]            = static_cast<Index>( size * loop + position );
+				regions[size + loop][position]     = static_cast<Index>( loop + size * position );
+				regions[2 * size + loop][position] = static_cast<Index>( order * size * ( loop / order ) + order * ( loop % order )
+				                                                       + size * ( position / order ) + position % order );
+			}
+		}
+		for( std::size_t index = 0; index != numberOfCells; ++index )
+		{
+			std::size_t count = 0;
+			for( std::size_t other = 0; other != numberOfCells; ++other )
+			{
+				const bool sameRow    = other / size == index / size;
+				const bool sameColumn = other % size == index % size;
+				const bool sameSquare = squareOf( other ) == squareOf( index );
+				if( other != index && ( sameRow || sameColumn || sameSquare ) )
+				{
+					peers[index][count++] = static_cast<Index>( other );
+				}
+			}
+		}
+		for( std::size_t square = 0; square != size; ++square )
+		{
+			const Index* squareCells = regions[2 * size + square];
+			for( std::size_t line = 0; line != 2 * order; ++line )
+			{
+				const Index* lineCells = line < order ? regions[squareCells[order * line] / size] : regions[size + squareCells[line - order] % size];
+				Intersection& intersection = intersections[2 * order * square + line];
+				std::size_t inSegment = 0;
+				std::size_t inSquare = 0;
+				std::size_t inLine = 0;
+				for( std::size_t position = 0; position != size; ++position )
+				{
+					if( std::find( lineCells, lineCells + size, squareCells[position] ) != lineCells + size ) { intersection.segment[inSegment++] = squareCells[position]; }
+					else                                                                                      { intersection.restOfSquare[inSquare++] = squareCells[position]; }
+					if( std::find( squareCells, squareCells + size, lineCells[position] ) == squareCells + size ) { intersection.restOfLine[inLine++] = lineCells[position]; }
+				}
+			}
+		}
+	}
+};
+
+template< std::size_t order > const std::size_t BoxGeometry<order>::size;
+template< std::size_t order > const std::size_t BoxGeometry<order>::numberOfCells;
+template< std::size_t order > const std::size_t BoxGeometry<order>::numberOfRegions;
+template< std::size_t order > const std::size_t BoxGeometry<order>::numberOfPeers;
+template< std::size_t order > const std::size_t BoxGeometry<order>::numberOfIntersections;
+template< std::size_t order > const typename BoxGeometry<order>::Mask BoxGeometry<order>::allDigits;
+
+/// The usual 9x9 grid.  There are 27 regions, each cell has 20 peers and there are 54 intersections.
+typedef BoxGeometry<3> GridGeometry;
+
+} // namespace Sudoku
+
+#endif // GRIDGEOMETRY_HPP_20261019
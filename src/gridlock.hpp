@@ -23,6 +23,7 @@ using std::copy;
 #include "grid.hpp"
 #include "constraintregion.hpp"
 #include "cell.hpp"
+#include "regionfish.hpp"
 
 namespace Sudoku {
 
@@ -44,6 +45,9 @@ namespace Sudoku {
  
     This extends to 3x3 and 4x4 gridlocks. It is worth noting in these cases that the candidate value need not appear in every single intersection, but 'n' 
     rows/columns must be covered by the cells containing the candidate value. 
+ 
+    For a grid that isn't regular, each region (the squares and the variant's regions too) is also searched as the first 
+    of two or three bases of a RegionFish, which finds the gridlocks that have one of the variant's regions in them.
 */	
 struct Gridlock 
 {
@@ -51,10 +55,37 @@ struct Gridlock
     static const bool usesGrid = true;
 
 	void operator()( ConstraintRegion& cr, Grid& grid, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
+	{
+		if( grid.regular() )
+		{
+			gridlock( cr, grid, changedCells, explanatoryCells, explanation );
+			return;
+		}
+		
+		const std::size_t number = grid.regionNumber( cr );
+		if( number < 18 )  // A row or a column
+		{
+			gridlock( cr, grid, changedCells, explanatoryCells, explanation );
+		}
+		// Only up to three bases here: with every region a possible base the search for four takes several times as long as
+		// the rest of the rule put together, and found nothing the smaller fish and the other rules didn't in the X and
+		// windoku puzzles it was tried on
+		for( std::size_t nn = 2; nn != 4; ++nn )
+		{
+			RegionFish fish( grid, nn, nn, changedCells, explanation );
+			for( char candidateValue = '1'; candidateValue != ':' && !grid.contradiction; ++candidateValue )
+			{
+				fish.search( number, candidateValue );
+			}
+		}
+	}
+
+private:	
+	/// The gridlocks between rows and columns, where cr is a row or a column
+	void gridlock( ConstraintRegion& cr, Grid& grid, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
 	{
 		// First build up a count of the various candidates
-		// Create a vector of many elements initialised to zero. Despite the waste of memory, we wont use the first n element, only using '1' - '9'.
-		vector<std::size_t> frequency = Constraint::buildCandidateFrequencyTable( cr );
+		const CandidateCounts counts = Constraint::countCandidates( cr );
 		
 		// Check for an NxN gridlock. (in the code I will use nn rather than n)
 		// Note that we can stop at 4x4 gridlock (because if there is a 5x5 then I think there exists a complementary 4x4 gridlock [should verify this])
@@ -62,9 +93,10 @@ struct Gridlock
 		for( std::size_t nn = 2; nn != 5; ++nn )
 		{
 			// Loop over the candidate value look for a potential gridlock
+			const CandidateSet::Mask possibleMask = counts.between( 2, nn );
 			for( char candidateValue = '1'; candidateValue != ':'; ++candidateValue )
 			{
-				if( frequency[candidateValue] > 1 && frequency[candidateValue] <= nn )
+				if( possibleMask & CandidateSet::bit( candidateValue ) )
 			    {
 					doNxNGridlockForValue( nn, candidateValue, cr, grid, changedCells, explanatoryCells, explanation );
 			    }
@@ -72,15 +104,14 @@ struct Gridlock
 		}
 	}
 
-private:	
 	vector<const ConstraintRegion*> findPossibleConstraintRegions( const std::size_t nn, const char candidateValue, const vector<ConstraintRegion>& allCR )
 	{
 		vector<const ConstraintRegion*> possibleConstraintRegions;
 		for( vector<ConstraintRegion>::const_iterator regionsIt = allCR.begin(); regionsIt != allCR.end(); ++regionsIt )
 		{
 			const ConstraintRegion& cr2 = *regionsIt;
-			const vector<std::size_t> frequency2 = Constraint::buildCandidateFrequencyTable( cr2 );				
-			if( frequency2[candidateValue] > 1 && frequency2[candidateValue] <= nn )
+			const std::size_t frequency2 = Constraint::countCandidates( cr2 ).count( candidateValue );
+			if( frequency2 > 1 && frequency2 <= nn )
 			{
 				//cout << "Adding to possible constraint regions: " << Constraint::calculateConstantIndex( cr2 ) << endl;
 				possibleConstraintRegions.push_back( &cr2 );
@@ -122,8 +153,8 @@ private:
 					assert( *regionsPtrIt != 0 );
 					const ConstraintRegion& cr2 = **regionsPtrIt;
 					const std::size_t cr2ConstantIndex = Constraint::calculateConstantIndex( cr2 );
-					const vector<std::size_t> frequency2 = Constraint::buildCandidateFrequencyTable( cr2 );				
-					if( frequency2[candidateValue] > 1 && frequency2[candidateValue] <= nn )
+					const std::size_t frequency2 = Constraint::countCandidates( cr2 ).count( candidateValue );
+					if( frequency2 > 1 && frequency2 <= nn )
 					{
 						preserveIndexes.insert( cr2ConstantIndex );
 						
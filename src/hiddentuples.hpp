@@ -50,8 +50,7 @@ struct HiddenTuples
 	void operator()( ConstraintRegion& cr, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
 	{
 		// First build up a count of the various candidates
-		// Create a vector of many elements initialised to zero. Despite the waste of memory, we wont use the first n element, only using '1' - '9'.
-		vector<std::size_t> frequency = Constraint::buildCandidateFrequencyTable( cr );
+		const CandidateCounts counts = Constraint::countCandidates( cr );
 		
 		// Now see if it is possible to make 'n' n-tuples (in the code I will use nn rather than n)
 		// Note that we can stop at 4-tuples (because if there is a 5-tuple then the given 4-tuple will complement it)
@@ -62,10 +61,11 @@ struct HiddenTuples
 			// For example, if the values 6 and 7 have a count of 2 then they could
 			// possibly be a 2-tuple, or could be part of a 3-tuple (with another value of course)
 			// Be careful of the chance of having two 2-tuples in a constraint region.
+			const CandidateSet::Mask possibleMask = counts.between( 0, nn );
 			vector<char> possibleValuesForNTuple;
 			for( char candidateValue = '1'; candidateValue != ':'; ++candidateValue )
 			{
-				if( nn >= frequency[candidateValue] )
+				if( possibleMask & CandidateSet::bit( candidateValue ) )
 				{
 					possibleValuesForNTuple.push_back(candidateValue);
 				}
@@ -95,6 +95,12 @@ struct HiddenTuples
 					// If we find n of the proposed n-tuple then eliminate the other candidate values from the n-tuple cells.
 					if( nn == iteratorsToCellsWithProposedTuple.size() )
 					{
+						CandidateSet::Mask tupleMask = 0;
+						for( vector<char>::const_iterator valueIt = proposedHiddenTuple.begin(); valueIt != proposedHiddenTuple.end(); ++valueIt )
+						{
+							tupleMask |= CandidateSet::bit( *valueIt );
+						}
+						
 						bool didWork = false;
 						// Iterators to all the cells containing the proposed tuple have been saved
 						// Note the double dereference necessary due to iterating over a container of iterators
@@ -103,9 +109,8 @@ struct HiddenTuples
 							// If the cell doesn't have any extra candidates apart from the (not-so)-hidden tuple then there is no need to remove anything
 							if( (**itIt)->candidates().size() != nn )
 							{
-								// Delete all existing candidates then reinsert the hidden (but now exposed) candidate values
-								(**itIt)->candidates().clear();				
-								copy(proposedHiddenTuple.begin(), proposedHiddenTuple.end(), back_insert_iterator<Cell::CandidateContainer>((**itIt)->candidates()) );
+								// Replace the existing candidates with the hidden (but now exposed) candidate values
+								(**itIt)->assign( tupleMask );
 								changedCells.insert((**itIt));	
 								didWork = true;
 							}
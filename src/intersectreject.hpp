@@ -19,6 +19,8 @@ using std::vector;
 using std::set;
 
 #include "constraintregion.hpp"
+#include "digitplanes.hpp"
+#include "regionfish.hpp"
 
 
 namespace Sudoku {
@@ -47,6 +49,9 @@ namespace Sudoku {
  *  8          1,4        5          |  2          7,9        3          |  6,7        1,4,6,7    1,4,9            
  *  4,9        6          1,3,4,7,9  |  8          5,7,9      5,9        |  2          1,3,4,7    1,4,9            
  *
+ *  A variant's regions intersect the others (and each other) in the same way, so for a grid that isn't regular the region
+ *  is also searched as the one base of a RegionFish.  The squares of a jigsaw are only searched that way, since the digit 
+ *  planes and the search below take the squares to be 3x3.
  */
 struct IntersectReject
 {
@@ -58,13 +63,50 @@ struct IntersectReject
 	// It is a precondition that UniquePerContraintRegion has been applied immediately before IntersectReject
 	void operator()( ConstraintRegion& cr, Grid& grid, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
 	{
-		// First build up a count of the various candidates
-		// Create a vector of many elements initialised to zero. Despite the waste of memory, we wont use the first n element, only using '1' - '9'.
-		vector<std::size_t> frequency = Constraint::buildCandidateFrequencyTable( cr );
+		if( grid.regular() )
+		{
+			reject( cr, grid, changedCells, explanatoryCells, explanation );
+			return;
+		}
 		
-		for( char candidateValue = '1'; candidateValue != ':'; ++candidateValue )  // Check each of the numbers to see if it is possible to intersect-reject it.
+		const std::size_t number = grid.regionNumber( cr );
+		if( !grid.irregular( number ) && !grid.jigsaw )
+		{
+			reject( cr, grid, changedCells, explanatoryCells, explanation );
+		}
+		RegionFish fish( grid, 1, 9, changedCells, explanation );
+		for( char candidateValue = '1'; candidateValue != ':' && !grid.contradiction; ++candidateValue )
+		{
+			fish.search( number, candidateValue );
+			for( vector<Cell*>::const_iterator it = fish.removed.begin(); it != fish.removed.end() && planes_.loaded(); ++it )
+			{
+				planes_.remove( (*it)->index(), candidateValue );
+			}
+			fish.removed.clear();
+		}
+	}
+	
+private:
+	DigitPlanes planes_;  // Loaded from the grid on the first region and then kept in step with the eliminations made
+	
+	/// Intersect reject between the rows, columns and 3x3 squares
+	void reject( ConstraintRegion& cr, Grid& grid, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
+	{
+		// First find the candidate values that have something to reject, using the digit planes of the whole grid.
+		// There must be two or three to fit into a single intersection.  The single frequency is found by OnlySpot.
+		if( !planes_.loaded() )
+		{
+			planes_.load( grid );
+		}
+		const CandidateSet::Mask rejectable = planes_.intersections( Constraint::calculateType( cr ), Constraint::calculateConstantIndex( cr ) );
+		if( !rejectable )
+		{
+			return;
+		}
+		
+		for( char candidateValue = '1'; candidateValue != ':'; ++candidateValue )  // Only the numbers found above will be intersect-rejected.
 		{			
-			if( frequency[candidateValue] >1 && frequency[candidateValue] <= 3 )  // There must be three or less to possibly fit into a single row or column.  The single frequency is found by OnlySpot.
+			if( rejectable & CandidateSet::bit( candidateValue ) )
 			{				
 				// Examine each candidate set for the containment of the candidate value and check if the candidate values all lie in the same row or same column
 				vector< Cell* > pointorsToCellsWithCandidateValue = Constraint::findCellsContainingCandidateValue( cr, candidateValue );
@@ -73,7 +115,7 @@ struct IntersectReject
 	            if( intersectType != undefined )	
 				{
 					// Fantastic, we have found an intersect reject.
-					assert( pointorsToCellsWithCandidateValue.size() == frequency[candidateValue] );
+					assert( pointorsToCellsWithCandidateValue.size() >= 2 && pointorsToCellsWithCandidateValue.size() <= 3 );
 					
 					// Figure out the appropriate row or column or square that needs fixing.
 					ConstraintRegion* pNeedFixingConstraintRegion = 0;
@@ -102,11 +144,9 @@ struct IntersectReject
 					{
 						if( (*crIt2)->index(constraintType) != preserveIndexNum )
 						{
-							const std::size_t candidateSizeBeforeRemoval = (*crIt2)->candidates().size();
-							(*crIt2)->candidates().remove(candidateValue);
-							
-							if( candidateSizeBeforeRemoval > (*crIt2)->candidates().size() )
+							if( (*crIt2)->remove(candidateValue) )
 							{
+								planes_.remove( (*crIt2)->index(), candidateValue );
 								changedCells.insert(*crIt2);	
 								didWork = true;
 							}
@@ -136,7 +176,6 @@ struct IntersectReject
 		}
 	}
 	
-private:
 	Type calculateIntersectionType( const vector< Cell* >& pointorsToCellsWithCandidateValue, const ConstraintRegion& cr )
 	{
 		assert( pointorsToCellsWithCandidateValue.size() >= 2 );
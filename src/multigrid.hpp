@@ -0,0 +1,243 @@
+/*
+ *  multigrid.hpp
+ *
+ */
+
+#ifndef MULTIGRID_HPP_20261019
+#define MULTIGRID_HPP_20261019
+
+#include <algorithm>
+
+#include <deque>
+using std::deque;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "grid.hpp"
+#include "solve.hpp"
+
+namespace Sudoku {
+
+/** Several 9x9 grids that overlap, such as the five grids of a samurai sudoku.  Each grid is placed (by its top left cell)
+ *  on a larger layout and a cell of the layout that is covered by two grids is a cell of both.
+ *
+ *  Every grid is an ordinary Grid solved by the ordinary rules.  A cell shared by two grids is a cell in each of them, linked
+ *  to its twin, because a Cell knows its row, column and square and those differ from one grid to the other.  When the rules
+ *  stall on a grid, each of its shared cells and the twin are cut down to the candidates they have in common.  Any grid
+ *  that loses a candidate that way is queued to be solved again, so a grid is only revisited when something it shares has
+ *  changed rather than every grid being solved over and over until none of them changes.
+ */
+class MultiGrid
+{
+public:
+	/// Where a grid's top left cell is on the layout
+	struct Placement
+	{
+		Placement( const std::size_t topRow, const std::size_t leftColumn ) : top( topRow ), left( leftColumn ) {}
+
+		std::size_t top;
+		std::size_t left;
+	};
+
+	/// The five grids of a samurai sudoku: one at each corner of a 21x21 layout, each sharing a square with the one in the middle
+	static vector<Placement> samurai()
+	{
+		vector<Placement> placements;
+		placements.push_back( Placement( 0, 0 ) );
+		placements.push_back( Placement( 0, 12 ) );
+		placements.push_back( Placement( 6, 6 ) );
+		placements.push_back( Placement( 12, 0 ) );
+		placements.push_back( Placement( 12, 12 ) );
+		return placements;
+	}
+
+	explicit MultiGrid( const vector<Placement>& placements )
+		: placements_( placements )
+		, height_( 0 )
+		, width_( 0 )
+	{
+		for( vector<Placement>::const_iterator it = placements_.begin(); it != placements_.end(); ++it )
+		{
+			grids_.push_back( new Grid() );
+			height_ = std::max( height_, it->top + 9 );
+			width_ = std::max( width_, it->left + 9 );
+		}
+
+		// Link every cell covered by two grids
+		linksOfGrid_.resize( grids_.size() );
+		for( std::size_t first = 0; first != placements_.size(); ++first )
+		{
+			for( std::size_t second = first + 1; second != placements_.size(); ++second )
+			{
+				for( std::size_t index = 0; index != 81; ++index )
+				{
+					const std::size_t row = placements_[first].top + index / 9;
+					const std::size_t column = placements_[first].left + index % 9;
+					if( row < placements_[second].top || row >= placements_[second].top + 9
+					 || column < placements_[second].left || column >= placements_[second].left + 9 )
+					{
+						continue;
+					}
+					Link link;
+					link.grid[0] = first;
+					link.cell[0] = index;
+					link.grid[1] = second;
+					link.cell[1] = 9 * ( row - placements_[second].top ) + column - placements_[second].left;
+					linksOfGrid_[first].push_back( links_.size() );
+					linksOfGrid_[second].push_back( links_.size() );
+					links_.push_back( link );
+				}
+			}
+		}
+	}
+
+	~MultiGrid()
+	{
+		for( vector<Grid*>::iterator it = grids_.begin(); it != grids_.end(); ++it )
+		{
+			delete *it;
+		}
+	}
+
+	std::size_t height() const { return height_; }
+	std::size_t width() const  { return width_; }
+	std::size_t size() const   { return grids_.size(); }
+
+	Grid& grid( const std::size_t which )             { return *grids_[which]; }
+	const Grid& grid( const std::size_t which ) const { return *grids_[which]; }
+
+	/// Load the puzzle from the lines of the layout ('1'-'9' for a given and anything else for an empty cell or a gap)
+	void load( const vector<string>& layout )
+	{
+		char givens[81];
+		for( std::size_t which = 0; which != grids_.size(); ++which )
+		{
+			for( std::size_t index = 0; index != 81; ++index )
+			{
+				const std::size_t row = placements_[which].top + index / 9;
+				const std::size_t column = placements_[which].left + index % 9;
+				givens[index] = ( row < layout.size() && column < layout[row].size() ) ? layout[row][column] : '0';
+			}
+			grids_[which]->load( givens );
+		}
+	}
+
+	/// Write the current values into the lines of the layout, '.' for a cell that isn't solved and ' ' where there is no grid
+	void values( vector<string>& layout ) const
+	{
+		layout.assign( height_, string( width_, ' ' ) );
+		char cellValues[81];
+		for( std::size_t which = 0; which != grids_.size(); ++which )
+		{
+			grids_[which]->values( cellValues );
+			for( std::size_t index = 0; index != 81; ++index )
+			{
+				layout[placements_[which].top + index / 9][placements_[which].left + index % 9] = ( cellValues[index] == '0' ) ? '.' : cellValues[index];
+			}
+		}
+	}
+
+	/** Check every grid for consistency, solve them all (as described above) and check the result.  The rules used in all
+	    the grids are returned in usage.  Unless it is solved the grids are left as far as the rules got.
+	*/
+	SolveStatus::Type solve( RuleUsage& usage, const SolveOptions& options )
+	{
+		usage = RuleUsage();
+		for( vector<Grid*>::iterator it = grids_.begin(); it != grids_.end(); ++it )
+		{
+			if( do_check( **it, false, options ) )
+			{
+				return SolveStatus::inconsistent;
+			}
+		}
+
+		deque<std::size_t> queue;
+		vector<bool> queued( grids_.size(), true );
+		for( std::size_t which = 0; which != grids_.size(); ++which )
+		{
+			queue.push_back( which );
+		}
+		while( !queue.empty() )
+		{
+			const std::size_t which = queue.front();
+			queue.pop_front();
+			queued[which] = false;
+
+			usage.add( Sudoku::solve( *grids_[which], options ) );
+			if( grids_[which]->contradiction )
+			{
+				return SolveStatus::inconsistent;
+			}
+			for( vector<std::size_t>::const_iterator it = linksOfGrid_[which].begin(); it != linksOfGrid_[which].end(); ++it )
+			{
+				if( !share( links_[*it], queue, queued ) )
+				{
+					return SolveStatus::inconsistent;
+				}
+			}
+		}
+
+		const bool overBudget = options.budget && options.budget->exceeded;
+		for( vector<Grid*>::iterator it = grids_.begin(); it != grids_.end(); ++it )
+		{
+			if( !(*it)->solved() && do_check( **it, true, options ) )
+			{
+				return overBudget ? SolveStatus::budgetExceeded : SolveStatus::unsolved;
+			}
+		}
+		return SolveStatus::solved;
+	}
+
+private:
+	MultiGrid( const MultiGrid& );
+	MultiGrid& operator=( const MultiGrid& );
+
+	/// A cell covered by two grids: its index in each of them
+	struct Link
+	{
+		std::size_t grid[2];
+		std::size_t cell[2];
+	};
+
+	/** Cut both cells of the link down to the candidates they have in common, queueing the grid of any cell that loses one.
+	    Returns false, without changing either, if they have none in common.
+	*/
+	bool share( const Link& link, deque<std::size_t>& queue, vector<bool>& queued )
+	{
+		Cell* cells[2] = { &grids_[link.grid[0]]->cells[link.cell[0]], &grids_[link.grid[1]]->cells[link.cell[1]] };
+		const CandidateSet::Mask common = cells[0]->candidates().mask() & cells[1]->candidates().mask();
+		if( !common )
+		{
+			return false;
+		}
+		for( std::size_t side = 0; side != 2; ++side )
+		{
+			if( cells[side]->candidates().mask() == common )
+			{
+				continue;
+			}
+			cells[side]->assign( common );
+			if( !queued[link.grid[side]] )
+			{
+				queue.push_back( link.grid[side] );
+				queued[link.grid[side]] = true;
+			}
+		}
+		return true;
+	}
+
+	vector<Placement> placements_;
+	std::size_t height_;
+	std::size_t width_;
+	vector<Grid*> grids_;                        // Not Grids, which can't be copied
+	vector<Link> links_;
+	vector< vector<std::size_t> > linksOfGrid_;  // For each grid, the links it takes part in
+};
+
+} // namespace Sudoku
+
+#endif // MULTIGRID_HPP_20261019
@@ -13,17 +13,19 @@ using std::vector;
 
 #include <set>
 using std::set;
-/*
+
 #include <iterator>
-using std::inserter;
+using std::back_inserter;
 
 #include <algorithm>
-using std::copy;
-*/
+using std::find;
+using std::set_intersection;
+
 #include "grid.hpp"
 #include "constraintregion.hpp"
 #include "cell.hpp"
 #include "chain.hpp"
+#include "solvebudget.hpp"
 
 namespace Sudoku {
 
@@ -47,6 +49,9 @@ namespace Sudoku {
  */	
 struct MultiValueChains 
 {
+	/// The searches are charged to the budget, if there is one
+	explicit MultiValueChains( SolveBudget* budget = 0 ) : budget_( budget ) {}
+	
 	const char* name() const { return "Multi-value chains"; }
 	static const bool usesGrid = true;
 
@@ -76,21 +81,22 @@ struct MultiValueChains
 						{
 							const Cell* const pEndCell = *(itChain->rbegin());
                             // Remove from matching constraint regions
-							for( Constraint::Type constraintType = static_cast<Constraint::Type>(0); constraintType != Constraint::grid; constraintType=static_cast<Constraint::Type>(constraintType+1) )
+							const vector<std::size_t>& startRegions = grid.regionsOfCell[pStartCell->index()];
+							const vector<std::size_t>& endRegions = grid.regionsOfCell[pEndCell->index()];
+							for( vector<std::size_t>::const_iterator regionIt = startRegions.begin(); regionIt != startRegions.end(); ++regionIt )
 							{
-								if( pStartCell->index(constraintType) == pEndCell->index(constraintType) )
+								if( find( endRegions.begin(), endRegions.end(), *regionIt ) != endRegions.end() )
 								{ 
 									set<std::size_t> preserveIndexes; 
 									preserveIndexes.insert( pStartCell->index() );
 									preserveIndexes.insert( pEndCell->index() );							
 									
-									const std::size_t matchIndex = pStartCell->index(constraintType); 
-									ConstraintRegion& eliminationRegion = grid.get(constraintType)[ matchIndex ];
+									ConstraintRegion& eliminationRegion = grid.region( *regionIt );
 									if( Constraint::eliminate( eliminationRegion, *itCandidateValue, changedCells, preserveIndexes, Constraint::grid ) )
 									{
 										ostringstream oss;
 										oss << "Eliminating candidate value "  << *itCandidateValue 
-											<< " from " << Constraint::typeToStr( constraintType ) << " " << matchIndex
+											<< " from " << Constraint::typeToStr( Grid::regionType( *regionIt ) ) << " " << Grid::regionIndex( *regionIt )
 											<< " due to multivalue chain: ";
 										writeChainWithValues( oss, *itChain ) << '\n';
 										explanation += oss.str();
@@ -101,7 +107,12 @@ struct MultiValueChains
 							}
 							
 							//Remove from intersection of constraint regions		
-							if( pStartCell->column() != pEndCell->column() && pEndCell->row() != pStartCell->row() && pStartCell->square() != pEndCell->square() )
+							if( !grid.regular() )
+							{
+								// Every cell that can see both ends, whichever regions it sees them through
+								eliminateFromCommonPeers( grid, pStartCell, pEndCell, *itCandidateValue, *itChain, changedCells, explanation );
+							}
+							else if( pStartCell->column() != pEndCell->column() && pEndCell->row() != pStartCell->row() && pStartCell->square() != pEndCell->square() )
 							{
 								ostringstream oss;
 								oss << " multivalue chain: ";
@@ -110,8 +121,8 @@ struct MultiValueChains
 								preserveCells.insert( pStartCell );
 								preserveCells.insert( pEndCell );					
 								
-								Constraint::eliminate( pStartCell, grid.get( Constraint::square )[pEndCell->square()], *itCandidateValue, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );
-								Constraint::eliminate( pEndCell, grid.get( Constraint::square )[pStartCell->square()], *itCandidateValue, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );								
+								Constraint::eliminate( grid, pStartCell, grid.get( Constraint::square )[pEndCell->square()], *itCandidateValue, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );
+								Constraint::eliminate( grid, pEndCell, grid.get( Constraint::square )[pStartCell->square()], *itCandidateValue, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );								
 							}
 						}
 					}
@@ -121,6 +132,26 @@ struct MultiValueChains
 	}
 
 private:	
+	void eliminateFromCommonPeers( Grid& grid, const Cell* pStartCell, const Cell* pEndCell, const char candidateValue, const Chain& chain, set<Cell*>& changedCells, string& explanation )
+	{
+		const vector<Cell*>& startPeers = grid.peers[pStartCell->index()];
+		const vector<Cell*>& endPeers = grid.peers[pEndCell->index()];
+		vector<Cell*> commonPeers;
+		set_intersection( startPeers.begin(), startPeers.end(), endPeers.begin(), endPeers.end(), back_inserter( commonPeers ) );
+		for( vector<Cell*>::const_iterator it = commonPeers.begin(); it != commonPeers.end(); ++it )
+		{
+			if( (*it)->remove( candidateValue ) )
+			{
+				changedCells.insert( *it );
+				ostringstream oss;
+				oss << "Eliminating candidate value "  << candidateValue << " from cell ";
+				(*it)->writeCellLocationInformation( oss ) << " due to multivalue chain: ";
+				writeChainWithValues( oss, chain ) << '\n';
+				explanation += oss.str();
+			}
+		}
+	}
+	
 	const char followChain( const char startCandidateValue, const Chain& chain )
 	{
 		char candidateValue = startCandidateValue;
@@ -138,29 +169,34 @@ private:
 	vector< Chain > findAllChains( const char searchCandidateValue, Cell* pStartCell, const Grid& grid )
 	{
 		vector< Chain > allChains;
-		for( Constraint::Type constraintType = static_cast<Constraint::Type>(0); constraintType != Constraint::grid; constraintType=static_cast<Constraint::Type>(constraintType+1) )
+		// Search each of the regions the cell is in (its row, column and square, and any regions of a variant)
+		const vector<std::size_t>& regions = grid.regionsOfCell[pStartCell->index()];
+		for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
 		{
 			Chain chain;
 			assert( pStartCell->candidates().size() == 2 );
 			chain.push_back( pStartCell );
-			findChainsInConstraintType( searchCandidateValue, grid, constraintType, chain, allChains );	
+			findChainsInRegion( searchCandidateValue, grid, *regionIt, chain, allChains );	
 		}				
 		return allChains;
 	}
 	
-	void findChainsInConstraintType(  const char searchCandidateValue
-									, const Grid& grid
-									, const Constraint::Type searchConstraintType
-									, Chain& currentChain
-									, vector< Chain >& allChains )
+	void findChainsInRegion(  const char searchCandidateValue
+							, const Grid& grid
+							, const std::size_t searchRegion
+							, Chain& currentChain
+							, vector< Chain >& allChains )
 	{
+		// Don't follow the chain any further if it is as long as the budget allows (or the budget has run out)
+		if( budget_ && !budget_->extendChain( currentChain.size() ) ) { return; }
+		
 		const Cell* const pSearchCell = *currentChain.rbegin();
 		
 		// If the current cell doesn't contain exactly two candidates then we can't search any further down this chain.
 		assert( pSearchCell->candidates().size() == 2 );
 		
 		// Get one of the constraint regions that the cell is in for searching
-		const ConstraintRegion& cr = grid.get( searchConstraintType )[ pSearchCell->index( searchConstraintType ) ];
+		const ConstraintRegion& cr = grid.region( searchRegion );
 
 		vector< Cell* > pointorsToCellsWithCandidateValue = Constraint::findCellsContainingCandidateValue( cr, searchCandidateValue );
 		
@@ -182,9 +218,10 @@ private:
 			{
 				Chain clone = currentChain;							
 				clone.push_back( *it );		
-				for( Constraint::Type constraintType = static_cast<Constraint::Type>(0); constraintType != Constraint::grid; constraintType=static_cast<Constraint::Type>(constraintType+1) )
+				const vector<std::size_t>& regions = grid.regionsOfCell[(*it)->index()];
+				for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
 				{
-					findChainsInConstraintType( (*nextSearchCellCandidates.begin()==searchCandidateValue)?(*nextSearchCellCandidates.rbegin()):(*nextSearchCellCandidates.begin()), grid, constraintType, clone, allChains );	
+					findChainsInRegion( (*nextSearchCellCandidates.begin()==searchCandidateValue)?(*nextSearchCellCandidates.rbegin()):(*nextSearchCellCandidates.begin()), grid, *regionIt, clone, allChains );	
 
 					// Don't keep a chain which only has one cell (useless) or two cells (a locked pair) and don't keep a duplicate record
 					if( clone.size() > 2 && find( allChains.begin(), allChains.end(), clone ) == allChains.end() )
@@ -195,6 +232,8 @@ private:
 			}
 		}
 	}
+
+	SolveBudget* budget_;
 };
 
 } // namespace Sudoku
@@ -37,29 +37,30 @@ struct OnlySpot
 	// If the value only appears once in _any_ of the candidates in the constraint region then that must be the value of the cell  
     void operator()( ConstraintRegion& cr, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
 	{
-		// First build up a count of the various candidates
-		// Create a vector of many elements initialised to zero. Despite the waste of memory, we wont use the first n element, only using '1' - '9'.
-		vector<std::size_t> frequency = Constraint::buildCandidateFrequencyTable( cr );
+		// First find the candidates that appear exactly once
+		const CandidateSet::Mask onlyOnce = Constraint::countCandidates( cr ).exactly( 1 );
+		if( !onlyOnce )
+		{
+			return;
+		}
 
-		// Check if the count is 1 for any of them
 		for( char candidateValue = '1'; candidateValue != ':'; ++candidateValue )
 		{
-			if( 1 == frequency[candidateValue] )
+			if( onlyOnce & CandidateSet::bit( candidateValue ) )
 			{
 				//std::cout << "Only spot found " << candidateValue << std::endl;
 				// Find where this value occurs and remove all other candidates for that cell.  
 				for( ConstraintRegion::iterator crIt = cr.begin(); crIt != cr.end(); ++crIt )
 				{
 					//std::cout << "Examining cell " << (*crIt)->index() << std::endl; 	
-					Cell::CandidateContainer& currentCandidates = (*crIt)->candidates();
+					const Cell::CandidateContainer& currentCandidates = (*crIt)->candidates();
 					if( currentCandidates.size() > 1
-					   && find(currentCandidates.begin(), currentCandidates.end(), candidateValue) != currentCandidates.end() )
+					   && currentCandidates.contains( candidateValue ) )
 					{
 						//std::cout << "Removing "<< candidateValue << "from cell "<< (*crIt)->index() << std::endl; 	
 						
 						// Delete all candidates then reinsert this candidate value
-						currentCandidates.clear();						
-						currentCandidates.push_back( candidateValue );
+						(*crIt)->assign( CandidateSet::bit( candidateValue ) );
 						explanatoryCells.insert(*crIt);
 						ostringstream oss;
 						oss << "Cell " << (*crIt)->index() << " is the only cell in " 
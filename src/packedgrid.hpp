@@ -0,0 +1,45 @@
+/*
+ *  packedgrid.hpp
+ *
+ */
+
+#ifndef PACKEDGRID_HPP_20261019
+#define PACKEDGRID_HPP_20261019
+
+#include <cstddef>
+
+namespace Sudoku {
+
+/** A grid of 81 digits packed two to a byte.  Cell 0 is in the low nibble of byte 0, cell 1 in the high nibble, and so on.
+ *  The value 0 means the cell is empty (or not yet solved).  The final byte only uses its low nibble.
+ */
+const std::size_t packedGridSize = 41;
+
+/// Pack 81 characters ('1'-'9' for a value, anything else for an empty cell) into packedGridSize bytes
+inline void packGrid( const char* cells, unsigned char* packed )
+{
+	for( std::size_t byteIndex = 0; byteIndex != packedGridSize; ++byteIndex )
+	{
+		packed[byteIndex] = 0;
+	}
+	for( std::size_t cellIndex = 0; cellIndex != 81; ++cellIndex )
+	{
+		const char value = cells[cellIndex];
+		const unsigned char digit = ( value >= '1' && value <= '9' ) ? static_cast<unsigned char>(value - '0') : 0;
+		packed[cellIndex/2] |= ( cellIndex % 2 ) ? static_cast<unsigned char>(digit << 4) : digit;
+	}
+}
+
+/// Unpack packedGridSize bytes into 81 characters, using '0' for an empty cell
+inline void unpackGrid( const unsigned char* packed, char* cells )
+{
+	for( std::size_t cellIndex = 0; cellIndex != 81; ++cellIndex )
+	{
+		const unsigned char digit = ( cellIndex % 2 ) ? (packed[cellIndex/2] >> 4) : (packed[cellIndex/2] & 0x0F);
+		cells[cellIndex] = static_cast<char>('0' + digit);
+	}
+}
+
+} // namespace Sudoku
+
+#endif // PACKEDGRID_HPP_20261019
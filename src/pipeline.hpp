@@ -0,0 +1,219 @@
+/*
+ *  pipeline.hpp
+ *
+ */
+
+#ifndef PIPELINE_HPP_20261019
+#define PIPELINE_HPP_20261019
+
+#include <pthread.h>
+
+#include <map>
+using std::map;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "boundedqueue.hpp"
+#include "corpusreader.hpp"
+#include "resultwriter.hpp"
+#include "ruleusage.hpp"
+
+namespace Sudoku {
+
+/// A puzzle on its way through the pipeline
+struct PipelineJob
+{
+	std::size_t sequence;   // Position of the puzzle in the input so that the results can be put back in order
+	bool end;               // No more puzzles follow this one (and it isn't a puzzle itself)
+	bool solved;
+	RuleUsage usage;
+	char givens[81];
+	char values[81];
+};
+
+
+/** Read, solve and write a batch of puzzle files with the three stages running concurrently.
+ *
+ *  A reader thread walks the files and feeds the puzzles through a bounded queue to the solver threads.  The solvers pass their
+ *  results through a second bounded queue to the writer (the calling thread) which puts them back into input order before 
+ *  handing them to the ResultWriter.  Because both queues are bounded, and the reader never gets more than a fixed number of 
+ *  puzzles ahead of the writer (so that one slow puzzle can't make the reordering grow), a stage that gets ahead simply 
+ *  waits for the others.  Memory use stays flat however big the batch is.
+ *
+ *  Each solver thread works on its own copy of worker, which must provide void operator()( PipelineJob* jobs, std::size_t count )
+ *  to fill in the solved, usage and values of each job from its givens, and a static const std::size_t batchSize.  A solver
+ *  takes as many puzzles as are waiting, up to batchSize, at a time (but never waits for more than one) so that the worker 
+ *  can solve them together.
+ */
+template< typename Worker >
+class Pipeline
+{
+public:
+	Pipeline( const vector<string>& filenames, const Worker& worker, const std::size_t numberOfSolvers, const std::size_t queueCapacity = 1024 )
+		: filenames_( filenames )
+		, worker_( worker )
+		, numberOfSolvers_( numberOfSolvers == 0 ? 1 : numberOfSolvers )
+		, puzzles_( queueCapacity )
+		, results_( queueCapacity )
+		, window_( 2 * puzzles_.capacity() + numberOfSolvers_ )
+		, written_(0)
+		, readerError_()
+	{}
+	
+	/// Run the whole batch, writing every result.  Throws std::runtime_error if any of the files couldn't be read.
+	void run( ResultWriter& writer )
+	{
+		pthread_t reader;
+		vector<pthread_t> solvers( numberOfSolvers_ );
+		if( pthread_create( &reader, 0, &Pipeline::readerThread, this ) != 0 )
+		{
+			throw std::runtime_error( "Unable to start the reader thread" );
+		}
+		for( std::size_t loop = 0; loop != numberOfSolvers_; ++loop )
+		{
+			if( pthread_create( &solvers[loop], 0, &Pipeline::solverThread, this ) != 0 )
+			{
+				throw std::runtime_error( "Unable to start a solver thread" );
+			}
+		}
+		
+		write( writer );
+		
+		pthread_join( reader, 0 );
+		for( std::size_t loop = 0; loop != numberOfSolvers_; ++loop )
+		{
+			pthread_join( solvers[loop], 0 );
+		}
+		writer.flush();
+		
+		if( !readerError_.empty() )
+		{
+			throw std::runtime_error( readerError_ );
+		}
+	}
+
+private:
+	static void* readerThread( void* self )
+	{
+		static_cast<Pipeline*>( self )->read();
+		return 0;
+	}
+	
+	static void* solverThread( void* self )
+	{
+		static_cast<Pipeline*>( self )->solve();
+		return 0;
+	}
+	
+	void read()
+	{
+		PipelineJob job;
+		job.end = false;
+		job.sequence = 0;
+		try
+		{
+			for( vector<string>::const_iterator it = filenames_.begin(); it != filenames_.end(); ++it )
+			{
+				CorpusReader reader( *it );
+				while( reader.next( job.givens ) )
+				{
+					for( std::size_t attempt = 0; job.sequence >= __atomic_load_n( &written_, __ATOMIC_ACQUIRE ) + window_; ++attempt )
+					{
+						backoff( attempt );
+					}
+					puzzles_.push( job );
+					++job.sequence;
+				}
+			}
+		}
+		catch( const std::exception& e )
+		{
+			readerError_ = e.what();  // Only read by the writer after this thread has been joined
+		}
+		
+		// Tell each of the solvers that there is nothing more to do
+		job.end = true;
+		for( std::size_t loop = 0; loop != numberOfSolvers_; ++loop )
+		{
+			puzzles_.push( job );
+		}
+	}
+	
+	void solve()
+	{
+		Worker worker( worker_ );
+		vector<PipelineJob> jobs( Worker::batchSize );
+		PipelineJob end;
+		for( end.end = false; !end.end; )
+		{
+			std::size_t count = 0;
+			for( puzzles_.pop( jobs[0] ); ; )
+			{
+				if( jobs[count].end ) { end = jobs[count]; break; }
+				if( ++count == jobs.size() || !puzzles_.tryPop( jobs[count] ) ) { break; }
+			}
+			
+			if( count )
+			{
+				worker( &jobs[0], count );
+			}
+			for( std::size_t loop = 0; loop != count; ++loop )
+			{
+				results_.push( jobs[loop] );
+			}
+		}
+		results_.push( end );  // Pass on the end
+	}
+	
+	void write( ResultWriter& writer )
+	{
+		map<std::size_t, PipelineJob> outOfOrder;
+		std::size_t nextSequence = 0;
+		std::size_t solversFinished = 0;
+		PipelineJob job;
+		while( solversFinished != numberOfSolvers_ )
+		{
+			results_.pop( job );
+			if( job.end )
+			{
+				++solversFinished;
+				continue;
+			}
+			
+			if( job.sequence != nextSequence )
+			{
+				outOfOrder[job.sequence] = job;
+				continue;
+			}
+			
+			writer.write( job.givens, job.values, job.solved, job.usage );
+			++nextSequence;
+			for( map<std::size_t, PipelineJob>::iterator it = outOfOrder.find( nextSequence ); it != outOfOrder.end(); it = outOfOrder.find( nextSequence ) )
+			{
+				writer.write( it->second.givens, it->second.values, it->second.solved, it->second.usage );
+				outOfOrder.erase( it );
+				++nextSequence;
+			}
+			__atomic_store_n( &written_, nextSequence, __ATOMIC_RELEASE );
+		}
+	}
+	
+	const vector<string>& filenames_;
+	const Worker worker_;
+	const std::size_t numberOfSolvers_;
+	BoundedQueue<PipelineJob> puzzles_;   // reader -> solvers
+	BoundedQueue<PipelineJob> results_;   // solvers -> writer
+	const std::size_t window_;            // The most puzzles that can be read but not yet written
+	std::size_t written_;                 // How many results the writer has written (only written by the writer)
+	string readerError_;
+};
+
+} // namespace Sudoku
+
+#endif // PIPELINE_HPP_20261019
@@ -0,0 +1,100 @@
+/*
+ *  puzzleformat.hpp
+ *
+ */
+
+#ifndef PUZZLEFORMAT_HPP_20261019
+#define PUZZLEFORMAT_HPP_20261019
+
+#include <cstring>
+
+#include "packedgrid.hpp"
+
+namespace Sudoku {
+
+/** Formatting of a grid of 81 characters ('1'-'9' for a value, anything else for an empty cell) into the file formats understood by CorpusReader.
+ *  Each function writes into a caller supplied buffer (which must hold at least maxFormattedSize bytes) and returns the number of bytes written.
+ *
+ *  The binary format is a 16 byte header followed by one record of packedGridSize bytes per grid, so grid n starts at byte 16 + 41n.
+ */
+const std::size_t maxFormattedSize = 9 * 18;
+
+const char binaryMagic[4] = { 'S', 'D', 'K', 'B' };
+const unsigned char binaryVersion = 1;
+const std::size_t binaryHeaderSize = 16;
+const std::size_t binaryRecordSize = packedGridSize;
+
+inline bool isValue( const char value ) { return value >= '1' && value <= '9'; }
+
+/// One line of 81 characters with '.' for an empty cell
+inline std::size_t formatLine( const char* cells, char* out )
+{
+	for( std::size_t index = 0; index != 81; ++index )
+	{
+		out[index] = isValue( cells[index] ) ? cells[index] : '.';
+	}
+	out[81] = '\n';
+	return 82;
+}
+
+/// Nine lines of nine characters with '.' for an empty cell
+inline std::size_t formatSDK( const char* cells, char* out )
+{
+	char* it = out;
+	for( std::size_t rowIndex = 0; rowIndex != 9; ++rowIndex )
+	{
+		for( std::size_t colIndex = 0; colIndex != 9; ++colIndex )
+		{
+			const char value = cells[rowIndex*9 + colIndex];
+			*it++ = isValue( value ) ? value : '.';
+		}
+		*it++ = '\n';
+	}
+	return it - out;
+}
+
+/// Nine lines of nine comma separated values with '0' for an empty cell
+inline std::size_t formatCSV( const char* cells, char* out )
+{
+	char* it = out;
+	for( std::size_t rowIndex = 0; rowIndex != 9; ++rowIndex )
+	{
+		for( std::size_t colIndex = 0; colIndex != 9; ++colIndex )
+		{
+			const char value = cells[rowIndex*9 + colIndex];
+			*it++ = isValue( value ) ? value : '0';
+			*it++ = ( colIndex == 8 ) ? '\n' : ',';
+		}
+	}
+	return it - out;
+}
+
+/// A single binary record (without the header)
+inline std::size_t formatBinary( const char* cells, char* out )
+{
+	packGrid( cells, reinterpret_cast<unsigned char*>( out ) );
+	return binaryRecordSize;
+}
+
+/// The header that must start every binary file
+inline std::size_t formatBinaryHeader( char* out )
+{
+	std::memset( out, 0, binaryHeaderSize );
+	std::memcpy( out, binaryMagic, sizeof(binaryMagic) );
+	out[4] = static_cast<char>( binaryVersion );
+	out[5] = static_cast<char>( binaryRecordSize );
+	return binaryHeaderSize;
+}
+
+/// Is this the start of a binary file that we can read?
+inline bool isBinaryHeader( const char* begin, const std::size_t size )
+{
+	return size >= binaryHeaderSize 
+	    && std::memcmp( begin, binaryMagic, sizeof(binaryMagic) ) == 0
+	    && static_cast<unsigned char>( begin[4] ) == binaryVersion
+	    && static_cast<unsigned char>( begin[5] ) == binaryRecordSize;
+}
+
+} // namespace Sudoku
+
+#endif // PUZZLEFORMAT_HPP_20261019
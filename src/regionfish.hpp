@@ -0,0 +1,206 @@
+/*
+ *  regionfish.hpp
+ *
+ */
+
+#ifndef REGIONFISH_HPP_20261019
+#define REGIONFISH_HPP_20261019
+
+#include <cstddef>
+
+#include <algorithm>
+using std::find;
+
+#include <set>
+using std::set;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "grid.hpp"
+#include "digitplanes.hpp"
+
+namespace Sudoku {
+
+/** Intersect Reject and Gridlock for regions of any shape, for the grids that aren't regular (see Grid::regular).
+ *
+ *  Take n regions (the bases) whose cells with a candidate value are all different cells, so that the value is in n
+ *  different cells of them, and n other regions (the covers) that have all of those cells between them.  A cover can only
+ *  have the value once, so each cover has one of the n and the value can be removed from the rest of the cells of the
+ *  covers.  With one base and one cover this is Intersect Reject, and with two to four rows and as many columns it is
+ *  Gridlock.  The same holds when a base or a cover is a diagonal, a window or a jigsaw square, and only those fish are
+ *  looked for here: the ones made of rows, columns and 3x3 squares alone are left to the rules' own searches.
+ *
+ *  The bases are picked out by the count the grid keeps of each value in each region (Grid::spots) before any of their
+ *  cells are looked at, and the cells are sets of bits so that whether two bases overlap, and what the covers have outside
+ *  the bases, is a mask test.  The covers are found by taking the regions of the first cell that isn't covered yet in turn.
+ */
+class RegionFish
+{
+public:
+	/** For fish of size bases whose bases have from 2 to maxSpots cells with the value.  Removals are added to changedCells
+	    and explained in explanation.
+	*/
+	RegionFish( Grid& grid, const std::size_t size, const std::size_t maxSpots, set<Cell*>& changedCells, string& explanation )
+		: grid_( grid )
+		, size_( size )
+		, maxSpots_( maxSpots )
+		, value_( '0' )
+		, regionCells_( grid.placed.size() )
+		, valueCells_( grid.placed.size() )
+		, changedCells_( changedCells )
+		, explanation_( explanation )
+	{
+		for( std::size_t number = 0; number != regionCells_.size(); ++number )
+		{
+			const ConstraintRegion& cr = grid.region( number );
+			for( ConstraintRegion::const_iterator it = cr.begin(); it != cr.end(); ++it ) { regionCells_[number].set( (*it)->index() ); }
+		}
+	}
+
+	/// Look for the fish on the value whose first base (in the numbering of Grid::regionsOfCell) is root
+	void search( const std::size_t root, const char value )
+	{
+		value_ = value;
+		plane_ = CellBits();
+		for( std::size_t index = 0; index != grid_.cells.size(); ++index )
+		{
+			if( grid_.cells[index].candidates().contains( value ) ) { plane_.set( index ); }
+		}
+		for( std::size_t number = 0; number != regionCells_.size(); ++number ) { valueCells_[number] = plane_ & regionCells_[number]; }
+
+		bases_.clear();
+		covers_.clear();
+		if( isBase( root, CellBits() ) )
+		{
+			bases_.push_back( root );
+			chooseBases( root + 1, valueCells_[root] );
+		}
+	}
+
+	vector<Cell*> removed;  // Every cell a value was removed from, for whoever keeps a copy of the candidates to clear
+
+private:
+	/// Whether the region can be a base: it has the right number of cells with the value and none of them is in the others
+	bool isBase( const std::size_t number, const CellBits& baseCells ) const
+	{
+		const std::size_t spots = grid_.spots[9 * number + ( value_ - '1' )];
+		return spots >= 2 && spots <= maxSpots_ && !( valueCells_[number] & baseCells ).any();
+	}
+
+	void chooseBases( const std::size_t first, const CellBits& baseCells )
+	{
+		if( bases_.size() == size_ )
+		{
+			bool irregular = false;
+			for( vector<std::size_t>::const_iterator it = bases_.begin(); it != bases_.end(); ++it )
+			{
+				irregular = irregular || grid_.irregular( *it );
+			}
+			chooseCovers( baseCells, CellBits(), irregular );
+			return;
+		}
+		for( std::size_t number = first; number != regionCells_.size() && !grid_.contradiction; ++number )
+		{
+			if( isBase( number, baseCells ) )
+			{
+				bases_.push_back( number );
+				chooseBases( number + 1, baseCells | valueCells_[number] );
+				bases_.pop_back();
+			}
+		}
+	}
+
+	/// Add covers until the bases are covered.  irregular is whether one of the bases or covers so far is irregular: if none
+	/// is then the last cover has to be.
+	void chooseCovers( const CellBits& baseCells, const CellBits& coverCells, const bool irregular )
+	{
+		const CellBits uncovered = baseCells & ~coverCells;
+		if( !uncovered.any() )
+		{
+			// Only a fish if there are as many covers as bases (fewer would mean the puzzle is broken)
+			if( covers_.size() == size_ && ( coverCells & plane_ & ~baseCells ).any() ) { eliminate( baseCells ); }
+			return;
+		}
+		if( covers_.size() == size_ ) { return; }
+
+		const bool last = covers_.size() + 1 == size_;
+		const vector<std::size_t>& regions = grid_.regionsOfCell[uncovered.first()];
+		for( vector<std::size_t>::const_iterator it = regions.begin(); it != regions.end() && !grid_.contradiction; ++it )
+		{
+			const bool irregularCover = grid_.irregular( *it );
+			if( ( irregular || irregularCover || !last ) 
+			 && !( last && ( uncovered & ~regionCells_[*it] ).any() )
+			 && find( bases_.begin(), bases_.end(), *it ) == bases_.end() )
+			{
+				covers_.push_back( *it );
+				chooseCovers( baseCells, coverCells | regionCells_[*it], irregular || irregularCover );
+				covers_.pop_back();
+			}
+		}
+	}
+
+	void eliminate( const CellBits& baseCells )
+	{
+		const CellBits removable = plane_ & ~baseCells;
+		CellBits removedCells;
+		for( vector<std::size_t>::const_iterator it = covers_.begin(); it != covers_.end(); ++it )
+		{
+			ConstraintRegion& cr = grid_.region( *it );
+			for( ConstraintRegion::iterator cellIt = cr.begin(); cellIt != cr.end(); ++cellIt )
+			{
+				const std::size_t index = (*cellIt)->index();
+				if( removable.contains( index ) && (*cellIt)->remove( value_ ) )
+				{
+					removedCells.set( index );
+					changedCells_.insert( *cellIt );
+					removed.push_back( *cellIt );
+				}
+			}
+		}
+		plane_ = plane_ & ~removedCells;
+		for( std::size_t number = 0; number != regionCells_.size(); ++number ) { valueCells_[number] = plane_ & regionCells_[number]; }
+
+		ostringstream oss;
+		oss << "Cells";
+		for( std::size_t index = 0; index != grid_.cells.size(); ++index )
+		{
+			if( baseCells.contains( index ) ) { oss << " " << index; }
+		}
+		oss << " must contain the candidate value " << value_ << " once for each of ";
+		writeRegions( oss, bases_ ) << " and are all in ";
+		writeRegions( oss, covers_ ) << ". Removing " << value_ << " from the other cells of those\n";
+		explanation_ += oss.str();
+	}
+
+	static ostream& writeRegions( ostream& os, const vector<std::size_t>& numbers )
+	{
+		for( vector<std::size_t>::const_iterator it = numbers.begin(); it != numbers.end(); ++it )
+		{
+			os << ( it == numbers.begin() ? "" : ", " ) << Constraint::typeToStr( Grid::regionType( *it ) ) << " " << Grid::regionIndex( *it );
+		}
+		return os;
+	}
+
+	Grid& grid_;
+	const std::size_t size_;
+	const std::size_t maxSpots_;
+	char value_;
+	CellBits plane_;                   // The cells with the value
+	vector<CellBits> regionCells_;     // The cells of each region, by region number
+	vector<CellBits> valueCells_;      // The cells of each region with the value
+	vector<std::size_t> bases_;        // Region numbers
+	vector<std::size_t> covers_;
+	set<Cell*>& changedCells_;
+	string& explanation_;
+};
+
+} // namespace Sudoku
+
+#endif // REGIONFISH_HPP_20261019
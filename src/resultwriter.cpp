@@ -0,0 +1,172 @@
+/*
+ *  resultwriter.cpp
+ *
+ */
+
+#include "resultwriter.hpp"
+#include "puzzleformat.hpp"
+using namespace Sudoku;
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/// The most that a single result can take up in any of the formats
+const std::size_t maxResultSize = 512;
+
+} // anonymous namespace
+
+
+ResultWriter::ResultWriter( const string& filename, const Format format, const std::size_t bufferSize )
+	: fd_(-1)
+	, ownsFd_(false)
+	, format_(format)
+	, buffer_( bufferSize < 2 * maxResultSize ? 2 * maxResultSize : bufferSize )
+	, used_(0)
+	, count_(0)
+{
+	if( filename == "-" )
+	{
+		fd_ = STDOUT_FILENO;
+	}
+	else
+	{
+		fd_ = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+		if( fd_ < 0 )
+		{
+			throw std::runtime_error( "Unable to create " + filename );
+		}
+		ownsFd_ = true;
+	}
+	start();
+}
+
+ResultWriter::ResultWriter( const int fd, const Format format, const std::size_t bufferSize )
+	: fd_(fd)
+	, ownsFd_(false)
+	, format_(format)
+	, buffer_( bufferSize < 2 * maxResultSize ? 2 * maxResultSize : bufferSize )
+	, used_(0)
+	, count_(0)
+{
+	start();
+}
+
+void ResultWriter::start()
+{
+	if( format_ == binary )
+	{
+		used_ += formatBinaryHeader( &buffer_[used_] );
+	}
+}
+
+ResultWriter::~ResultWriter()
+{
+	try
+	{
+		flush();
+	}
+	catch( ... )
+	{
+		// Nothing sensible can be done about a failed write in a destructor
+	}
+	if( ownsFd_ )
+	{
+		::close( fd_ );
+	}
+}
+
+ResultWriter::Format ResultWriter::formatFromName( const string& name )
+{
+	if( name == "line" )   { return line; }
+	if( name == "csv" )    { return csv; }
+	if( name == "binary" ) { return binary; }
+	if( name == "json" )   { return json; }
+	throw std::runtime_error( "Unknown result format " + name );
+}
+
+void ResultWriter::write( const char* givens, const char* values, const bool solved, const RuleUsage& usage )
+{
+	if( buffer_.size() - used_ < maxResultSize )
+	{
+		flush();
+	}
+	
+	char* out = &buffer_[used_];
+	switch( format_ )
+	{
+		case line   : used_ += formatLine( values, out );   break;
+		case csv    : used_ += formatCSV( values, out );    break;
+		case binary : used_ += formatBinary( values, out ); break;
+		case json   : used_ += formatJSON( givens, values, solved, usage, out ); break;
+		default: throw std::runtime_error("Impossible result format");
+	}
+	++count_;
+}
+
+void ResultWriter::writeError( const string& message )
+{
+	if( format_ == binary )
+	{
+		throw std::logic_error( "The binary result format can't hold an error" );
+	}
+	if( buffer_.size() - used_ < maxResultSize )
+	{
+		flush();
+	}
+	
+	// Keep the message short and free of anything that would need escaping (or would end the line)
+	string text = message.substr( 0, maxResultSize / 2 );
+	for( string::iterator it = text.begin(); it != text.end(); ++it )
+	{
+		if( *it == '"' || *it == '\\' || static_cast<unsigned char>( *it ) < ' ' ) { *it = '?'; }
+	}
+	
+	char* out = &buffer_[used_];
+	if( format_ == json )
+	{
+		used_ += std::sprintf( out, "{\"n\":%lu,\"error\":\"%s\"}\n", static_cast<unsigned long>( count_ ), text.c_str() );
+	}
+	else
+	{
+		used_ += std::sprintf( out, "error: %s\n", text.c_str() );
+	}
+	++count_;
+}
+
+void ResultWriter::flush()
+{
+	const char* it = buffer_.empty() ? 0 : &buffer_[0];
+	std::size_t remaining = used_;
+	while( remaining > 0 )
+	{
+		const ssize_t written = ::write( fd_, it, remaining );
+		if( written < 0 )
+		{
+			if( errno == EINTR ) { continue; }
+			throw std::runtime_error( "Unable to write results" );
+		}
+		it += written;
+		remaining -= written;
+	}
+	used_ = 0;
+}
+
+/// {"n":0,"solved":true,"rules":21,"puzzle":"...","solution":"..."}
+std::size_t ResultWriter::formatJSON( const char* givens, const char* values, const bool solved, const RuleUsage& usage, char* out ) const
+{
+	char* it = out;
+	it += std::sprintf( it, "{\"n\":%lu,\"solved\":%s,\"rules\":%lu,\"puzzle\":\"", 
+	                    static_cast<unsigned long>( count_ ), solved ? "true" : "false", static_cast<unsigned long>( usage.applied ) );
+	it += formatLine( givens, it ) - 1;  // Overwrite the newline
+	it += std::sprintf( it, "\",\"solution\":\"" );
+	it += formatLine( values, it ) - 1;
+	it += std::sprintf( it, "\"}\n" );
+	return it - out;
+}
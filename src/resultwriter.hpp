@@ -0,0 +1,69 @@
+/*
+ *  resultwriter.hpp
+ *
+ */
+
+#ifndef RESULTWRITER_HPP_20261019
+#define RESULTWRITER_HPP_20261019
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "ruleusage.hpp"
+
+namespace Sudoku {
+
+/** Append the results of many solves to a single output file (or stdout).
+ *  Results are formatted into a large buffer which is only written out when it fills up, so there is one system call per
+ *  bufferSize bytes rather than a file (or even a write) per puzzle.
+ *
+ *  Every puzzle gets a result, in the order they were written, so that results line up with the puzzles they came from.  
+ *  An unsolved puzzle is written with its unsolved cells empty.
+ */
+class ResultWriter
+{
+public:
+	enum Format { line, csv, binary, json };
+	
+	/// Create (truncating) the output file.  A filename of "-" means stdout.  Throws std::runtime_error if the file can't be created.
+	ResultWriter( const string& filename, const Format format, const std::size_t bufferSize = 1 << 20 );
+	
+	/// Write to an already open file descriptor (e.g., a socket).  The descriptor is not closed by the writer.
+	ResultWriter( const int fd, const Format format, const std::size_t bufferSize );
+	~ResultWriter();
+	
+	/// Append a result.  Both givens and values are 81 characters ('1'-'9' for a value, anything else for an empty cell).
+	void write( const char* givens, const char* values, const bool solved, const RuleUsage& usage );
+	
+	/// Append a result for a request that couldn't be solved at all (e.g., it wasn't a puzzle).  Throws std::logic_error for the binary format.
+	void writeError( const string& message );
+	
+	/// Write out everything buffered so far
+	void flush();
+	
+	std::size_t count() const { return count_; }
+	
+	/// Convert "line", "csv", "binary" or "json" to a format.  Throws std::runtime_error for anything else.
+	static Format formatFromName( const string& name );
+
+private:
+	ResultWriter( const ResultWriter& );             // Not copyable
+	ResultWriter& operator=( const ResultWriter& );
+	
+	void start();
+	std::size_t formatJSON( const char* givens, const char* values, const bool solved, const RuleUsage& usage, char* out ) const;
+	
+	int fd_;
+	bool ownsFd_;
+	Format format_;
+	vector<char> buffer_;
+	std::size_t used_;
+	std::size_t count_;
+};
+
+} // namespace Sudoku
+
+#endif // RESULTWRITER_HPP_20261019
@@ -0,0 +1,134 @@
+/*
+ *  rulescheduler.hpp
+ *
+ */
+
+#ifndef RULESCHEDULER_HPP_20261019
+#define RULESCHEDULER_HPP_20261019
+
+#include <stdint.h>
+
+#include <cstddef>
+
+#include "ruleusage.hpp"
+
+namespace Sudoku {
+
+/** What the expensive rules have paid off so far, to decide the order they are tried in (see AdaptiveStage).
+ *
+ *  For each rule and for each bucket of how far the solve has got (by the number of candidates left in the grid), the
+ *  scheduler counts how often the rule was tried, how many candidates it (and the naked singles that followed it)
+ *  eliminated and how long it took.  The rules are ranked by eliminations per microsecond, so that, e.g., the chain
+ *  searches drop to the back wherever Gridlock has been doing the job for less.  Until every rule has been tried a few
+ *  times in a bucket the rules keep their usual order there, so none is pushed ahead of a cheaper one before it has
+ *  shown what it is worth.
+ *
+ *  A rule whose last skipAfter tries in a bucket all eliminated nothing is only offered there one time in skipPeriod, and 
+ *  as soon as one of those tries pays off it is offered every time again.  That is enough tries in a row that a rule which
+ *  merely pays off now and then (as Intersect Reject does) isn't left out for long, since leaving it out would just leave
+ *  its work to a more expensive rule.
+ *
+ *  The counts are kept from one puzzle to the next, so the order is learnt from the corpus being solved.  A scheduler is
+ *  not thread safe: each Solver has its own.
+ */
+struct RuleScheduler
+{
+	static const std::size_t numberOfBuckets = 4;
+	static const std::size_t trials = 4;       // Tries in a bucket before the rule is ranked by what it has done
+	static const std::size_t skipAfter = 16;   // Fruitless tries in a row in a bucket before the rule may be left out there
+	static const std::size_t skipPeriod = 8;   // How seldom a rule that has stopped paying off in a bucket is offered there
+
+	struct Entry
+	{
+		Entry() : attempts(0), eliminations(0), nanoseconds(0), fruitlessTries(0), skips(0) {}
+
+		uint64_t attempts;
+		uint64_t eliminations;
+		uint64_t nanoseconds;
+		uint64_t fruitlessTries;  // Tries in a row that eliminated nothing
+		uint64_t skips;           // Times the rule was left out since it was last offered
+	};
+
+	/// The bucket of a grid with this many candidates left: 0 when nearly solved up to numberOfBuckets-1 when nearly empty
+	static std::size_t bucket( const std::size_t candidates )
+	{
+		const std::size_t extra = candidates > 81 ? candidates - 81 : 0;
+		const std::size_t result = extra * numberOfBuckets / ( 729 - 81 + 1 );
+		return result < numberOfBuckets ? result : numberOfBuckets - 1;
+	}
+
+	/** Write the rules in mask (one bit per RuleUsage::Rule) into order, best first for a grid with this many candidates.
+	    Until each of them has had its trials in the bucket they keep their usual order, as do rules that are equally good.
+	    The rules whose last skipAfter tries there eliminated nothing are left out, except one time in skipPeriod.
+	    Returns the number of rules written.
+	*/
+	std::size_t order( const unsigned mask, const std::size_t candidates, RuleUsage::Rule* rules )
+	{
+		Entry* row = entries[bucket( candidates )];
+		bool ranked = true;
+		for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule )
+		{
+			ranked = ranked && ( !( mask & ( 1u << rule ) ) || row[rule].attempts >= trials );
+		}
+		
+		double scores[RuleUsage::numberOfRules];
+		std::size_t count = 0;
+		for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule )
+		{
+			if( !( mask & ( 1u << rule ) ) ) { continue; }
+
+			// Insertion sort, the new rule going after any that score the same
+			const double score = ranked ? this->score( row[rule] ) : 0.0;
+			std::size_t position = count++;
+			for( ; position != 0 && scores[position - 1] < score; --position )
+			{
+				scores[position] = scores[position - 1];
+				rules[position] = rules[position - 1];
+			}
+			scores[position] = score;
+			rules[position] = static_cast<RuleUsage::Rule>( rule );
+		}
+		
+		// Thin out the rules that have stopped paying off
+		std::size_t kept = 0;
+		for( std::size_t position = 0; position != count; ++position )
+		{
+			Entry& entry = row[rules[position]];
+			if( fruitless( entry ) && ++entry.skips != skipPeriod )
+			{
+				continue;
+			}
+			entry.skips = 0;
+			rules[kept++] = rules[position];
+		}
+		return kept;
+	}
+
+	/// Record a try of the rule on a grid that had this many candidates
+	void record( const RuleUsage::Rule rule, const std::size_t candidates, const std::size_t eliminated, const uint64_t elapsed )
+	{
+		Entry& entry = entries[bucket( candidates )][rule];
+		++entry.attempts;
+		entry.eliminations += eliminated;
+		entry.nanoseconds += elapsed;
+		entry.fruitlessTries = eliminated == 0 ? entry.fruitlessTries + 1 : 0;
+	}
+
+	Entry entries[numberOfBuckets][RuleUsage::numberOfRules];
+
+private:
+	static bool fruitless( const Entry& entry )
+	{
+		return entry.fruitlessTries >= skipAfter;
+	}
+
+	/// Eliminations per microsecond, with one elimination in the first microsecond assumed so that no rule scores nothing
+	static double score( const Entry& entry )
+	{
+		return ( entry.eliminations + 1.0 ) * 1000.0 / ( entry.nanoseconds + 1000.0 );
+	}
+};
+
+} // namespace Sudoku
+
+#endif // RULESCHEDULER_HPP_20261019
@@ -0,0 +1,127 @@
+/*
+ *  rulestatistics.hpp
+ *
+ */
+
+#ifndef RULESTATISTICS_HPP_20261019
+#define RULESTATISTICS_HPP_20261019
+
+#include <stdint.h>
+#include <time.h>
+
+#include <iomanip>
+#include <ostream>
+using std::ostream;
+
+#include "constraintregion.hpp"
+#include "ruleusage.hpp"
+
+namespace Sudoku {
+
+/// A monotonic clock reading in nanoseconds
+inline uint64_t nanoseconds()
+{
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return static_cast<uint64_t>( now.tv_sec ) * 1000000000ULL + now.tv_nsec;
+}
+
+
+/** How often each rule was applied to each type of region (row, column, square, the whole grid or extra), how often that made progress, how many 
+ *  candidates it eliminated and how long it took.  The consistency checks are not a rule but they are recorded as well (as the 
+ *  entry after the last rule).
+ *
+ *  The counters are updated atomically so one set of statistics can be shared by several solver threads and read (e.g., by
+ *  write) while they are still solving.
+ */
+struct RuleStatistics
+{
+	static const std::size_t consistencyCheck = RuleUsage::numberOfRules;
+	static const std::size_t numberOfEntries = RuleUsage::numberOfRules + 1;
+	static const std::size_t numberOfRegionTypes = Constraint::extra + 1;   // row, column, square, the whole grid at once and extra regions
+	
+	struct Entry
+	{
+		Entry() : invocations(0), productive(0), eliminations(0), nanoseconds(0) {}
+		
+		void add( const Entry& other )
+		{
+			invocations += other.invocations;
+			productive += other.productive;
+			eliminations += other.eliminations;
+			nanoseconds += other.nanoseconds;
+		}
+		
+		uint64_t invocations;    // How many times the rule was applied to all the regions of a type
+		uint64_t productive;     // How many of those applications changed the grid
+		uint64_t eliminations;   // How many candidates were removed
+		uint64_t nanoseconds;
+	};
+	
+	void record( const std::size_t entry, const Constraint::Type regionType, const bool didWork, const std::size_t eliminated, const uint64_t elapsed )
+	{
+		Entry& counters = entries[entry][regionType];
+		__atomic_fetch_add( &counters.invocations, 1, __ATOMIC_RELAXED );
+		__atomic_fetch_add( &counters.productive, didWork ? 1 : 0, __ATOMIC_RELAXED );
+		__atomic_fetch_add( &counters.eliminations, eliminated, __ATOMIC_RELAXED );
+		__atomic_fetch_add( &counters.nanoseconds, elapsed, __ATOMIC_RELAXED );
+	}
+	
+	/// The entry summed over all the region types
+	Entry total( const std::size_t entry ) const
+	{
+		Entry result;
+		for( std::size_t regionType = 0; regionType != numberOfRegionTypes; ++regionType )
+		{
+			result.add( entries[entry][regionType] );
+		}
+		return result;
+	}
+	
+	void add( const RuleStatistics& other )
+	{
+		for( std::size_t entry = 0; entry != numberOfEntries; ++entry )
+		{
+			for( std::size_t regionType = 0; regionType != numberOfRegionTypes; ++regionType )
+			{
+				entries[entry][regionType].add( other.entries[entry][regionType] );
+			}
+		}
+	}
+	
+	static const char* name( const std::size_t entry )
+	{
+		static const char* const names[numberOfEntries] = 
+		{ 
+			"Unique Per Constraint Region", "Only Spot", "Locked Tuples", "Hidden Tuples", "XYZ Wing", 
+			"Intersect Reject", "Gridlock", "Single-value chains", "Multi-value chains", "Inconsistency" 
+		};
+		return names[entry];
+	}
+	
+	/// Write a table of every rule and region type that was used
+	ostream& write( ostream& os ) const
+	{
+		os << std::left << std::setw(38) << "Rule" << std::right << std::setw(12) << "calls" << std::setw(12) << "productive" 
+		   << std::setw(14) << "eliminations" << std::setw(14) << "us" << '\n';
+		for( std::size_t entry = 0; entry != numberOfEntries; ++entry )
+		{
+			for( std::size_t regionType = 0; regionType != numberOfRegionTypes; ++regionType )
+			{
+				const Entry& counters = entries[entry][regionType];
+				if( counters.invocations == 0 ) { continue; }
+				
+				os << std::left << std::setw(30) << name( entry ) << std::setw(8) << Constraint::typeToStr( static_cast<Constraint::Type>( regionType ) ) 
+				   << std::right << std::setw(12) << counters.invocations << std::setw(12) << counters.productive 
+				   << std::setw(14) << counters.eliminations << std::setw(14) << counters.nanoseconds / 1000 << '\n';
+			}
+		}
+		return os;
+	}
+	
+	Entry entries[numberOfEntries][numberOfRegionTypes];
+};
+
+} // namespace Sudoku
+
+#endif // RULESTATISTICS_HPP_20261019
@@ -0,0 +1,53 @@
+/*
+ *  ruleusage.hpp
+ *
+ */
+
+#ifndef RULEUSAGE_HPP_20261019
+#define RULEUSAGE_HPP_20261019
+
+#include <cstddef>
+
+namespace Sudoku {
+
+/** A compact summary of which rules were needed to solve a puzzle.  
+ *  The rule identifiers are ordered (roughly) by difficulty so the highest bit set in the mask is the hardest rule that was used.
+ */
+struct RuleUsage
+{
+	enum Rule { uniquePerConstraintRegion=0, onlySpot, lockedTuples, hiddenTuples, xyzWing, intersectReject, gridlock, singleValueChains, multiValueChains, numberOfRules };
+
+	RuleUsage() : applied(0), mask(0) {}
+
+	void record( const Rule rule )
+	{
+		++applied;
+		mask |= static_cast<unsigned short>( 1u << rule );
+	}
+
+	bool used( const Rule rule ) const { return ( mask & ( 1u << rule ) ) != 0; }
+
+	/// Add the rules used in another solve (e.g., of another part of the same puzzle)
+	void add( const RuleUsage& other )
+	{
+		applied += other.applied;
+		mask |= other.mask;
+	}
+
+	/// Return the hardest rule that was used or numberOfRules if no rules were applied
+	Rule hardest() const
+	{
+		for( int rule = numberOfRules - 1; rule >= 0; --rule )
+		{
+			if( used( static_cast<Rule>(rule) ) ) { return static_cast<Rule>(rule); }
+		}
+		return numberOfRules;
+	}
+
+	std::size_t applied;   // How many times a rule made progress on the grid
+	unsigned short mask;   // Bit n is set if Rule n made progress at least once
+};
+
+} // namespace Sudoku
+
+#endif // RULEUSAGE_HPP_20261019
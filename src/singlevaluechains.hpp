@@ -24,6 +24,7 @@ using std::set_intersection;
 #include "constraintregion.hpp"
 #include "cell.hpp"
 #include "chain.hpp"
+#include "solvebudget.hpp"
 
 namespace Sudoku {
 
@@ -31,6 +32,9 @@ namespace Sudoku {
 */	
 struct SingleValueChains 
 {
+	/// The searches are charged to the budget, if there is one
+	explicit SingleValueChains( SolveBudget* budget = 0 ) : budget_( budget ) {}
+	
 	const char* name() const { return "Single-value chains"; }
 	static const bool usesGrid = true;
 
@@ -75,13 +79,13 @@ private:
 				    {
 						Cell* pCellAtIntersection = *chain0.rbegin() ;
 					   
-						Cell::CandidateContainer& currentCandidates = pCellAtIntersection->candidates();
+						const Cell::CandidateContainer& currentCandidates = pCellAtIntersection->candidates();
 						if( currentCandidates.size() > 1
-						  && find(currentCandidates.begin(), currentCandidates.end(), candidateValue) != currentCandidates.end() )
+						  && currentCandidates.contains( candidateValue ) )
 						{
 							//std::cout << "Removing "<< candidateValue << "from cell "<< pCellAtIntersection->index() << std::endl; 	
 							// Remove the candidate value from the cell at the intersection
-							currentCandidates.remove( candidateValue );
+							pCellAtIntersection->remove( candidateValue );
 							ostringstream oss;
 							oss << "Removing " << candidateValue << " from cell " << pCellAtIntersection->index();
 							pCellAtIntersection->writeCellShortLocationInformation(oss) << " because of the single value chains {";
@@ -117,37 +121,42 @@ private:
 	{
 		vector< Chain > allChains;
 		
-		for( Constraint::Type constraintType = static_cast<Constraint::Type>(0); constraintType != Constraint::grid; constraintType=static_cast<Constraint::Type>(constraintType+1) )
+		// Search each of the regions the cell is in (its row, column and square, and any regions of a variant)
+		const vector<std::size_t>& regions = grid.regionsOfCell[pStartCell->index()];
+		for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
 		{
 			Chain chain;
 			chain.push_back( pStartCell );
-			findChainsInConstraintType( candidateValue, grid, constraintType, chain, allChains );	
+			findChainsInRegion( candidateValue, grid, *regionIt, chain, allChains );	
 		}
 		
 		return allChains;
 	}
 	
-	void findChainsInConstraintType( const char candidateValue
-								   , const Grid& grid
-								   , const Constraint::Type searchConstraintType
-								   , Chain& currentChain
-								   , vector< Chain >& allChains )
+	void findChainsInRegion( const char candidateValue
+						   , const Grid& grid
+						   , const std::size_t searchRegion
+						   , Chain& currentChain
+						   , vector< Chain >& allChains )
 	{
+		// Don't follow the chain any further if it is as long as the budget allows (or the budget has run out)
+		if( budget_ && !budget_->extendChain( currentChain.size() ) ) { return; }
+		
 		const Cell* const pSearchCell = *currentChain.rbegin();
 		// No point in going any further if the candidate value is not in the search cell
-		if( find(pSearchCell->candidates().begin(), pSearchCell->candidates().end(), candidateValue) == pSearchCell->candidates().end() ){ return; }
+		if( !pSearchCell->candidates().contains( candidateValue ) ){ return; }
 		
 		// Get one of the constraint regions that the cell is in for searching
-		const ConstraintRegion& cr = grid.get( searchConstraintType )[ pSearchCell->index( searchConstraintType ) ];
+		const ConstraintRegion& cr = grid.region( searchRegion );
 		
 		// A bi-directional chain will have a frequency of 2 for the candidate value.  A uni-directional link will have a frequency > 2.
 		// A chain can only have a uni-directional link as its last element
-		vector<std::size_t> frequency = Constraint::buildCandidateFrequencyTable( cr );
+		const std::size_t frequency = Constraint::countCandidates( cr ).count( candidateValue );
 		
-		if( frequency[candidateValue] >= 2 )
+		if( frequency >= 2 )
 		{
 			vector< Cell* > pointorsToCellsWithCandidateValue = Constraint::findCellsContainingCandidateValue( cr, candidateValue );
-			assert( pointorsToCellsWithCandidateValue.size() == frequency[candidateValue] );
+			assert( pointorsToCellsWithCandidateValue.size() == frequency );
 			
 			// If a cell is already in the chain then remove it from the cells that need further exploration
 			for( Chain::const_iterator it = currentChain.begin(); it != currentChain.end(); ++it )
@@ -165,12 +174,13 @@ private:
 				clone.push_back( *it );					
 				
 				// Only if this is a bi-directional link do we need to recurse.
-				if( frequency[candidateValue] == 2  ) 
+				if( frequency == 2  ) 
 				{
-					for( Constraint::Type constraintType = static_cast<Constraint::Type>(0); constraintType != Constraint::grid; constraintType=static_cast<Constraint::Type>(constraintType+1) )
+					const vector<std::size_t>& regions = grid.regionsOfCell[(*it)->index()];
+					for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
 					{
 						assert( pointorsToCellsWithCandidateValue.size() == 1 );
-						findChainsInConstraintType( candidateValue, grid, constraintType, clone, allChains );	
+						findChainsInRegion( candidateValue, grid, *regionIt, clone, allChains );	
 					}
 				}
 				else // Only record chains that end in a uni-directional link					
@@ -180,6 +190,8 @@ private:
 			}
 		}
 	}
+
+	SolveBudget* budget_;
 };
 
 } // namespace Sudoku
@@ -0,0 +1,312 @@
+/*
+ *  solutionindex.cpp
+ *
+ */
+
+#include "solutionindex.hpp"
+using namespace Sudoku;
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char indexMagic[8] = { 'S', 'D', 'K', 'I', 'N', 'D', 'X', '1' };
+
+/// The file header.  Records start immediately after it.
+struct Header
+{
+	char magic[8];
+	uint32_t recordSize;
+	uint32_t reserved;
+};
+
+// Compile time checks that the on-disk structures have no hidden padding
+typedef char RecordSizeCheck[ sizeof(SolutionIndex::Record) == 96 ? 1 : -1 ];
+typedef char HeaderSizeCheck[ sizeof(Header) == 16 ? 1 : -1 ];
+
+/// FNV-1a
+uint64_t hashBytes( const unsigned char* bytes, const std::size_t length )
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for( std::size_t loop = 0; loop != length; ++loop )
+	{
+		hash ^= bytes[loop];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/** Relabel the digits of givens in order of first appearance.  toCanonical[d] is the canonical label of digit d. 
+ *  Digits that aren't in the givens are given the left over labels in increasing order.
+ */
+void canonicalise( const char* givens, char* canonical, char* toCanonical )
+{
+	std::memset( toCanonical, 0, 10 );
+	char nextLabel = '1';
+	for( std::size_t cellIndex = 0; cellIndex != 81; ++cellIndex )
+	{
+		const char value = givens[cellIndex];
+		if( value >= '1' && value <= '9' )
+		{
+			if( !toCanonical[value - '0'] )
+			{
+				toCanonical[value - '0'] = nextLabel++;
+			}
+			canonical[cellIndex] = toCanonical[value - '0'];
+		}
+		else
+		{
+			canonical[cellIndex] = '0';
+		}
+	}
+	for( std::size_t digit = 1; digit != 10; ++digit )
+	{
+		if( !toCanonical[digit] )
+		{
+			toCanonical[digit] = nextLabel++;
+		}
+	}
+}
+
+void makeKey( const char* givens, SolutionIndex::Record& key, char* toCanonical )
+{
+	char canonical[81];
+	canonicalise( givens, canonical, toCanonical );
+	packGrid( canonical, key.givens );
+	key.hash = hashBytes( key.givens, packedGridSize );
+}
+
+/// Hold a mutex for the lifetime of the lock
+class Lock
+{
+public:
+	explicit Lock( pthread_mutex_t& mutex ) : mutex_( mutex ) { pthread_mutex_lock( &mutex_ ); }
+	~Lock() { pthread_mutex_unlock( &mutex_ ); }
+private:
+	pthread_mutex_t& mutex_;
+};
+
+} // anonymous namespace
+
+
+SolutionIndex::SolutionIndex()
+	: fd_(-1)
+	, map_(0)
+	, mapLength_(0)
+	, mappedRecords_(0)
+	, mappedCount_(0)
+	, appended_()
+	, table_()
+{
+	pthread_mutex_init( &mutex_, 0 );
+}
+
+SolutionIndex::~SolutionIndex()
+{
+	close();
+	pthread_mutex_destroy( &mutex_ );
+}
+
+void SolutionIndex::close()
+{
+	if( map_ )
+	{
+		munmap( map_, mapLength_ );
+	}
+	if( fd_ >= 0 )
+	{
+		::close( fd_ );
+	}
+	fd_ = -1;
+	map_ = 0;
+	mapLength_ = 0;
+	mappedRecords_ = 0;
+	mappedCount_ = 0;
+	appended_.clear();
+	table_.clear();
+}
+
+void SolutionIndex::open( const string& filename )
+{
+	close();
+	
+	fd_ = ::open( filename.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644 );
+	if( fd_ < 0 )
+	{
+		throw std::runtime_error( "Unable to open solution index " + filename );
+	}
+	
+	struct stat status;
+	if( fstat( fd_, &status ) != 0 )
+	{
+		close();
+		throw std::runtime_error( "Unable to stat solution index " + filename );
+	}
+	
+	std::size_t fileSize = static_cast<std::size_t>( status.st_size );
+	if( fileSize == 0 )
+	{
+		Header header;
+		std::memcpy( header.magic, indexMagic, sizeof(indexMagic) );
+		header.recordSize = sizeof(Record);
+		header.reserved = 0;
+		if( write( fd_, &header, sizeof(header) ) != static_cast<ssize_t>(sizeof(header)) )
+		{
+			close();
+			throw std::runtime_error( "Unable to write header of solution index " + filename );
+		}
+		fileSize = sizeof(Header);
+	}
+	
+	// A partial record at the end of the file can only come from an interrupted append.  Drop it.
+	const std::size_t completeSize = fileSize < sizeof(Header) ? fileSize : sizeof(Header) + (fileSize - sizeof(Header)) / sizeof(Record) * sizeof(Record);
+	if( completeSize != fileSize && ftruncate( fd_, completeSize ) != 0 )
+	{
+		close();
+		throw std::runtime_error( "Unable to truncate partial record from solution index " + filename );
+	}
+	
+	map_ = mmap( 0, completeSize, PROT_READ, MAP_SHARED, fd_, 0 );
+	if( map_ == MAP_FAILED )
+	{
+		map_ = 0;
+		close();
+		throw std::runtime_error( "Unable to map solution index " + filename );
+	}
+	mapLength_ = completeSize;
+	
+	const Header* header = static_cast<const Header*>( map_ );
+	if( completeSize < sizeof(Header) 
+	   || std::memcmp( header->magic, indexMagic, sizeof(indexMagic) ) != 0 
+	   || header->recordSize != sizeof(Record) )
+	{
+		close();
+		throw std::runtime_error( filename + " is not a solution index" );
+	}
+	
+	mappedRecords_ = reinterpret_cast<const Record*>( header + 1 );
+	mappedCount_ = ( completeSize - sizeof(Header) ) / sizeof(Record);
+	rebuildTable( 2 * mappedCount_ );
+}
+
+const SolutionIndex::Record& SolutionIndex::record( const std::size_t recordNumber ) const
+{
+	return ( recordNumber < mappedCount_ ) ? mappedRecords_[recordNumber] : appended_[recordNumber - mappedCount_];
+}
+
+/// Return the slot that either contains the key or is the empty slot where the key would go
+std::size_t SolutionIndex::findSlot( const Record& key ) const
+{
+	const std::size_t mask = table_.size() - 1;
+	std::size_t slot = static_cast<std::size_t>( key.hash ) & mask;
+	while( table_[slot] != 0 )
+	{
+		const Record& candidate = record( table_[slot] - 1 );
+		if( candidate.hash == key.hash && std::memcmp( candidate.givens, key.givens, packedGridSize ) == 0 )
+		{
+			break;
+		}
+		slot = ( slot + 1 ) & mask;
+	}
+	return slot;
+}
+
+void SolutionIndex::addToTable( const std::size_t recordNumber )
+{
+	const std::size_t slot = findSlot( record( recordNumber ) );
+	if( table_[slot] == 0 )
+	{
+		table_[slot] = static_cast<uint32_t>( recordNumber + 1 );
+	}
+}
+
+void SolutionIndex::rebuildTable( const std::size_t minimumSlots )
+{
+	std::size_t slots = 64;
+	while( slots < minimumSlots )
+	{
+		slots *= 2;
+	}
+	table_.assign( slots, 0 );
+	for( std::size_t recordNumber = 0; recordNumber != size(); ++recordNumber )
+	{
+		addToTable( recordNumber );
+	}
+}
+
+bool SolutionIndex::find( const char* givens, char* solution, RuleUsage* usage ) const
+{
+	Record key;
+	char toCanonical[10];
+	makeKey( givens, key, toCanonical );
+	
+	Lock lock( mutex_ );
+	if( table_.empty() ) { return false; }
+	const std::size_t slot = findSlot( key );
+	if( table_[slot] == 0 ) { return false; }
+	
+	const Record& found = record( table_[slot] - 1 );
+	char fromCanonical[10];
+	for( std::size_t digit = 1; digit != 10; ++digit )
+	{
+		fromCanonical[ toCanonical[digit] - '0' ] = static_cast<char>( '0' + digit );
+	}
+	
+	char canonicalSolution[81];
+	unpackGrid( found.solution, canonicalSolution );
+	for( std::size_t cellIndex = 0; cellIndex != 81; ++cellIndex )
+	{
+		const char value = canonicalSolution[cellIndex];
+		solution[cellIndex] = ( value == '0' ) ? '0' : fromCanonical[ value - '0' ];
+	}
+	
+	if( usage )
+	{
+		usage->applied = found.rulesApplied;
+		usage->mask = found.ruleMask;
+	}
+	return true;
+}
+
+void SolutionIndex::insert( const char* givens, const char* solution, const RuleUsage& usage )
+{
+	if( !isOpen() ) { throw std::runtime_error( "Solution index is not open" ); }
+	
+	Record newRecord;
+	std::memset( &newRecord, 0, sizeof(newRecord) );
+	char toCanonical[10];
+	makeKey( givens, newRecord, toCanonical );
+	
+	char canonicalSolution[81];
+	for( std::size_t cellIndex = 0; cellIndex != 81; ++cellIndex )
+	{
+		const char value = solution[cellIndex];
+		canonicalSolution[cellIndex] = ( value >= '1' && value <= '9' ) ? toCanonical[ value - '0' ] : '0';
+	}
+	packGrid( canonicalSolution, newRecord.solution );
+	newRecord.rulesApplied = static_cast<uint32_t>( usage.applied );
+	newRecord.ruleMask = usage.mask;
+	
+	Lock lock( mutex_ );
+	if( table_[ findSlot( newRecord ) ] != 0 ) { return; }
+	if( write( fd_, &newRecord, sizeof(newRecord) ) != static_cast<ssize_t>(sizeof(newRecord)) )
+	{
+		throw std::runtime_error( "Unable to append to solution index" );
+	}
+	
+	appended_.push_back( newRecord );
+	if( 2 * size() > table_.size() )
+	{
+		rebuildTable( 2 * table_.size() );
+	}
+	else
+	{
+		addToTable( size() - 1 );
+	}
+}
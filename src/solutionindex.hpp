@@ -0,0 +1,88 @@
+/*
+ *  solutionindex.hpp
+ *
+ */
+
+#ifndef SOLUTIONINDEX_HPP_20261019
+#define SOLUTIONINDEX_HPP_20261019
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "packedgrid.hpp"
+#include "ruleusage.hpp"
+
+namespace Sudoku {
+
+/** A persistent, append-only index from a puzzle to its solution and a summary of the rules needed to solve it.
+ *
+ *  The index file is a small header followed by fixed size records.  At startup the file is memory mapped and a hash table 
+ *  of record numbers is built over it so that a lookup never has to touch more than a record or two.  New solutions are appended 
+ *  to the end of the file, so an interrupted run loses at most the partial record it was writing.
+ *
+ *  Puzzles are keyed on a canonical form in which the digits are relabelled in order of first appearance (reading along the rows).
+ *  This means that a puzzle which is just a relabelling of one that has already been solved is also found in the index.
+ *
+ *  find and insert may be called from several threads at once.
+ */
+class SolutionIndex
+{
+public:
+	SolutionIndex();
+	~SolutionIndex();
+	
+	/// Open (creating if necessary) the index stored in the given file.  Throws std::runtime_error if the file is not a valid index.
+	void open( const string& filename );
+	
+	bool isOpen() const { return fd_ >= 0; }
+	
+	/// The number of solutions in the index
+	std::size_t size() const { return mappedCount_ + appended_.size(); }
+	
+	/** Look up the puzzle described by givens (81 characters, '1'-'9' for a given, anything else for an empty cell).
+	 *  If found then 81 characters of solution are written to solution, the usage is filled in (if non-null) and true is returned.
+	 */
+	bool find( const char* givens, char* solution, RuleUsage* usage = 0 ) const;
+	
+	/// Append a solution to the index (and the file).  Solutions that are already in the index are not added again.
+	void insert( const char* givens, const char* solution, const RuleUsage& usage );
+	
+	/// The on-disk layout of a single solution.  The layout has no padding so it can be mapped directly.
+	struct Record
+	{
+		uint64_t hash;                              // Hash of the packed canonical givens
+		uint32_t rulesApplied;                      // RuleUsage::applied
+		uint16_t ruleMask;                          // RuleUsage::mask
+		unsigned char givens[packedGridSize];       // Canonical givens
+		unsigned char solution[packedGridSize];     // Solution using the canonical labels
+	};
+
+private:
+	SolutionIndex( const SolutionIndex& );             // Not copyable
+	SolutionIndex& operator=( const SolutionIndex& );
+	
+	void close();
+	const Record& record( const std::size_t recordNumber ) const;
+	std::size_t findSlot( const Record& key ) const;
+	void addToTable( const std::size_t recordNumber );
+	void rebuildTable( const std::size_t minimumSlots );
+	
+	int fd_;
+	void* map_;                     // The mapping of the whole file at open time
+	std::size_t mapLength_;
+	const Record* mappedRecords_;   // Records that were in the file at open time
+	std::size_t mappedCount_;
+	vector<Record> appended_;       // Records added since the file was opened (these follow on from the mapped records)
+	vector<uint32_t> table_;        // Open addressing hash table of record number + 1 (0 means an empty slot)
+	mutable pthread_mutex_t mutex_; // Guards appended_ and table_ (which insert can change under find)
+};
+
+} // namespace Sudoku
+
+#endif // SOLUTIONINDEX_HPP_20261019
@@ -0,0 +1,544 @@
+/*
+ *  solve.hpp
+ *
+ */
+
+#ifndef SOLVE_HPP_20261019
+#define SOLVE_HPP_20261019
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <iterator>
+using std::back_insert_iterator;
+using std::ostream_iterator;
+
+#include <algorithm>
+using std::copy;
+
+#include <sstream>
+using std::istringstream;
+
+#include <vector>
+using std::vector;
+
+#include <stdexcept>
+
+#include "grid.hpp"
+#include "ruleusage.hpp"
+#include "rulescheduler.hpp"
+#include "rulestatistics.hpp"
+#include "solvebudget.hpp"
+#include "inconsistency.hpp"
+#include "uniqueperconstraintregion.hpp"
+#include "onlyspot.hpp"
+#include "lockedtuples.hpp"
+#include "hiddentuples.hpp"
+
+#include "intersectreject.hpp"
+#include "gridlock.hpp"
+#include "xyzwing.hpp"
+#include "singlevaluechains.hpp"
+#include "multivaluechains.hpp"
+
+namespace Sudoku {
+
+struct SolveOptions
+{
+	SolveOptions() : verbose( true ), statistics( 0 ), rules( allRules ), budget( 0 ), fastPath( true ), extraRegions( 0 ), scheduler( 0 ) {}
+	
+	static const unsigned short allRules = ( 1u << RuleUsage::numberOfRules ) - 1;
+	
+	bool enabled( const RuleUsage::Rule rule ) const { return ( rules & ( 1u << rule ) ) != 0; }
+	
+	bool verbose;                  // Explain each step of the solve on stdout
+	RuleStatistics* statistics;    // If not null then every rule application is counted and timed.  When null the cost is a test of the pointer.
+	unsigned short rules;          // The rules that may be applied, one bit per RuleUsage::Rule
+	SolveBudget* budget;           // If not null then every rule application (and chain search) is charged to the budget and nothing runs once it is exceeded
+	bool fastPath;                 // Let a Solver try the singles and intersections on bitboards (see BitboardSingles) before the rules.  Never when verbose.
+	const ExtraRegions* extraRegions;  // If not null then a Solver adds these regions of a variant to its grid (and doesn't use the fast path)
+	RuleScheduler* scheduler;      // If not null then the expensive rules are tried in the order that has paid off so far (see AdaptiveStage)
+};
+
+
+/** How the solve of a puzzle ended */
+struct SolveStatus
+{
+	enum Type { solved=0, unsolved, inconsistent, budgetExceeded };
+	
+	static const char* typeToStr( const Type type )
+	{
+		static const char* const names[] = { "solved", "unsolved", "inconsistent", "budget exceeded" };
+		return names[type];
+	}
+};
+
+
+template< typename Function >
+bool do_grid_function( Grid& grid, Function func, const Constraint::Type type, const std::size_t rule, const SolveOptions& options )
+{
+	const uint64_t start = options.statistics ? nanoseconds() : 0;
+	const std::size_t candidatesBefore = options.statistics ? grid.candidateCount() : 0;
+	bool didWork = false;
+	//	apply_merge( grid, func, changedCells, explanatoryCells, explanation );
+	set<Cell*> changedCells;
+	set<Cell*> explanatoryCells;
+	string explanation;
+	
+	vector<ConstraintRegion>& regions = grid.get(type);
+	for( vector<ConstraintRegion>::iterator it = regions.begin(); it != regions.end() && !grid.contradiction; ++it )
+	{
+		func( *it, grid, changedCells, explanatoryCells, explanation );
+	}		
+	
+	if(changedCells.size() > 0)
+	{ 
+		if( options.verbose )
+		{
+			cout << "Apply " << func.name() << " rule to " << Constraint::typeToStr( type ) << "s.\n"; 
+			//copy (changedCells.begin(), changedCells.end(), ostream_iterator<std::size_t> (cout, " "));
+			cout << explanation << endl << grid << endl;
+		}
+		didWork = true;
+	}
+	
+	if( options.statistics )
+	{
+		options.statistics->record( rule, type, didWork, candidatesBefore - grid.candidateCount(), nanoseconds() - start );
+	}
+	return didWork;
+}
+
+
+template< typename Function >
+bool do_function( Grid& grid, Function func, const Constraint::Type type, const std::size_t rule, const SolveOptions& options )
+{
+	const uint64_t start = options.statistics ? nanoseconds() : 0;
+	const std::size_t candidatesBefore = options.statistics ? grid.candidateCount() : 0;
+	bool didWork = false;
+	//	apply_merge( grid, func, changedCells, explanatoryCells, explanation );
+	set<Cell*> changedCells;
+	set<Cell*> explanatoryCells;
+	string explanation;
+	
+	vector<ConstraintRegion>& regions = grid.get(type);
+	for( vector<ConstraintRegion>::iterator it = regions.begin(); it != regions.end() && !grid.contradiction; ++it )
+	{
+		func( *it, changedCells, explanatoryCells, explanation );
+	}	
+
+	if(changedCells.size() > 0)
+	{ 
+		if( options.verbose )
+		{
+			cout << "Apply " << func.name() << " rule to " << Constraint::typeToStr( type ) << "s.\n"; 
+			//copy (changedCells.begin(), changedCells.end(), ostream_iterator<std::size_t> (cout, " "));
+			cout << explanation << endl << grid << endl;
+		}
+		didWork = true;
+	}
+	
+	if( options.statistics )
+	{
+		options.statistics->record( rule, type, didWork, candidatesBefore - grid.candidateCount(), nanoseconds() - start );
+	}
+	return didWork;
+}
+
+
+/** Remove the values of the solved cells from their peers through the queue of UniquePerConstraintRegion::propagate.  This
+    does what repeated sweeps of UniquePerConstraintRegion over the regions would do but there is no explanation, so it is
+    only used when not verbose.  The application is counted against the whole grid.
+*/
+inline bool do_propagate( Grid& grid, const std::size_t rule, const SolveOptions& options )
+{
+	const uint64_t start = options.statistics ? nanoseconds() : 0;
+	const std::size_t candidatesBefore = options.statistics ? grid.candidateCount() : 0;
+	const bool didWork = UniquePerConstraintRegion::propagate( grid );
+	if( options.statistics )
+	{
+		options.statistics->record( rule, Constraint::grid, didWork, candidatesBefore - grid.candidateCount(), nanoseconds() - start );
+	}
+	return didWork;
+}
+
+
+/** Apply the function to every square, row and column, and to the extra regions of a variant.  The rule is the 
+    RuleStatistics entry that the applications are counted against.
+*/
+template< typename Function >
+bool do_function( Grid& grid, Function func, const std::size_t rule, const SolveOptions& options )
+{
+	bool didWork = false;
+	didWork |= do_function( grid, func, Constraint::square, rule, options );
+	didWork |= do_function( grid, func, Constraint::row, rule, options );
+	didWork |= do_function( grid, func, Constraint::column, rule, options );
+	if( !grid.extras.empty() )
+	{
+		didWork |= do_function( grid, func, Constraint::extra, rule, options );
+	}
+		
+	return didWork;
+}
+
+/** Apply the function to the types of region asked for (the extra regions only if the grid has any) */
+template< typename Function >
+bool do_grid_function( Grid& grid, Function func, bool doRow, bool doColumn, bool doSquare, bool doExtra, const std::size_t rule, const SolveOptions& options )
+{
+	bool didWork = false;
+	
+	if( doRow )
+	{
+		didWork |= do_grid_function( grid, func, Constraint::row, rule, options );	
+	}
+	if( doColumn )
+	{
+		didWork |= do_grid_function( grid, func, Constraint::column, rule, options );	
+	}
+	if( doSquare )
+	{
+		didWork |= do_grid_function( grid, func, Constraint::square, rule, options );	
+	}
+	if( doExtra && !grid.extras.empty() )
+	{
+		didWork |= do_grid_function( grid, func, Constraint::extra, rule, options );	
+	}
+	
+	return didWork;
+}
+
+
+/** How each rule is applied, and to which regions.  There is one specialisation per rule, so naming a rule that doesn't
+    exist in a RuleList (below) fails to compile.  The rules that look beyond a region reach the regions of a variant 
+    through the regions and peers of each cell, and Gridlock also searches from the squares and the variant's regions when
+    the grid isn't regular.
+*/
+template< RuleUsage::Rule rule > struct RuleApplication;
+
+template<> struct RuleApplication< RuleUsage::uniquePerConstraintRegion >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) 
+	{ 
+		return options.verbose ? do_function( grid, UniquePerConstraintRegion(), RuleUsage::uniquePerConstraintRegion, options ) 
+		                       : do_propagate( grid, RuleUsage::uniquePerConstraintRegion, options ); 
+	}
+};
+template<> struct RuleApplication< RuleUsage::onlySpot >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_function( grid, OnlySpot(), RuleUsage::onlySpot, options ); }
+};
+template<> struct RuleApplication< RuleUsage::lockedTuples >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_function( grid, LockedTuples(), RuleUsage::lockedTuples, options ); }
+};
+template<> struct RuleApplication< RuleUsage::hiddenTuples >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_function( grid, HiddenTuples(), RuleUsage::hiddenTuples, options ); }
+};
+template<> struct RuleApplication< RuleUsage::xyzWing >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_grid_function( grid, XYZWing(), false, false, true, true, RuleUsage::xyzWing, options ); }
+};
+template<> struct RuleApplication< RuleUsage::intersectReject >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_grid_function( grid, IntersectReject(), true, true, true, true, RuleUsage::intersectReject, options ); }
+};
+template<> struct RuleApplication< RuleUsage::gridlock >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) { return do_grid_function( grid, Gridlock(), true, true, !grid.regular(), true, RuleUsage::gridlock, options ); }
+};
+template<> struct RuleApplication< RuleUsage::singleValueChains >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) 
+	{ 
+		return do_grid_function( grid, SingleValueChains( options.budget ), true, false, false, false, RuleUsage::singleValueChains, options ); 
+	}
+};
+template<> struct RuleApplication< RuleUsage::multiValueChains >
+{
+	static bool apply( Grid& grid, const SolveOptions& options ) 
+	{ 
+		return do_grid_function( grid, MultiValueChains( options.budget ), true, false, false, false, RuleUsage::multiValueChains, options ); 
+	}
+};
+
+
+/// Whether the rule may be applied now (it is enabled and, if there is a budget, the budget will pay for it)
+inline bool mayApply( const RuleUsage::Rule rule, const SolveOptions& options )
+{
+	return options.enabled( rule ) && !( options.budget && !options.budget->spendRuleApplication() );
+}
+
+/** Apply a single rule once, to the regions that the solve applies it to.  Returns true if the rule made progress. */
+template< RuleUsage::Rule rule >
+inline bool applyRule( Grid& grid, const SolveOptions& options )
+{
+	return mayApply( rule, options ) && RuleApplication< rule >::apply( grid, options );
+}
+
+/** The same for a rule chosen at run time */
+inline bool applyRule( Grid& grid, const RuleUsage::Rule rule, const SolveOptions& options )
+{
+	switch( rule )
+	{
+		case RuleUsage::uniquePerConstraintRegion : return applyRule< RuleUsage::uniquePerConstraintRegion >( grid, options ); break;
+		case RuleUsage::onlySpot                  : return applyRule< RuleUsage::onlySpot >( grid, options ); break;
+		case RuleUsage::lockedTuples              : return applyRule< RuleUsage::lockedTuples >( grid, options ); break;
+		case RuleUsage::hiddenTuples              : return applyRule< RuleUsage::hiddenTuples >( grid, options ); break;
+		case RuleUsage::xyzWing                   : return applyRule< RuleUsage::xyzWing >( grid, options ); break;
+		case RuleUsage::intersectReject           : return applyRule< RuleUsage::intersectReject >( grid, options ); break;
+		case RuleUsage::gridlock                  : return applyRule< RuleUsage::gridlock >( grid, options ); break;
+		case RuleUsage::singleValueChains         : return applyRule< RuleUsage::singleValueChains >( grid, options ); break;
+		case RuleUsage::multiValueChains          : return applyRule< RuleUsage::multiValueChains >( grid, options ); break;
+		default: throw std::runtime_error("Impossible rule");
+	}
+}
+
+
+/** Whether there is no point in applying the rule: the grid is already solved or known to be broken, or the rule made no
+    progress the last time and no candidate has gone since (the candidates only ever go, so the same count is the same grid).
+    Otherwise the count is returned in candidates, for stalled to record if the rule fails again.
+*/
+inline bool cannotProgress( const Grid& grid, const RuleUsage::Rule rule, std::size_t& candidates )
+{
+	if( grid.contradiction || grid.solved() )
+	{
+		return true;
+	}
+	candidates = grid.candidateCount();
+	return grid.stalledAt[rule] == candidates;
+}
+
+/** Apply the rule once and then remove any solved values from their regions.  Returns true if anything made progress. */
+template< RuleUsage::Rule rule >
+inline bool applyRuleAndUnique( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+{
+	std::size_t candidates = 0;
+	if( cannotProgress( grid, rule, candidates ) ) { return false; }
+	
+	bool didWork = false;
+	if( applyRule< rule >( grid, options ) ){ didWork = true; usage.record( rule ); }
+	else                                    { grid.stalledAt[rule] = candidates; }
+	while( applyRule< RuleUsage::uniquePerConstraintRegion >( grid, options ) ){ didWork = true; usage.record( RuleUsage::uniquePerConstraintRegion ); }
+	return didWork;
+}
+
+inline bool applyRuleAndUnique( Grid& grid, const RuleUsage::Rule rule, RuleUsage& usage, const SolveOptions& options )
+{
+	std::size_t candidates = 0;
+	if( cannotProgress( grid, rule, candidates ) ) { return false; }
+	
+	bool didWork = false;
+	if( applyRule( grid, rule, options ) ){ didWork = true; usage.record( rule ); }
+	else                                  { grid.stalledAt[rule] = candidates; }
+	while( applyRule< RuleUsage::uniquePerConstraintRegion >( grid, options ) ){ didWork = true; usage.record( RuleUsage::uniquePerConstraintRegion ); }
+	return didWork;
+}
+
+
+/** The rules a solve uses, fixed at compile time so that the whole loop is inlined with no dispatch on the rule.
+ *
+ *  A RuleList is the rules of one stage, applied in order (each followed by Unique Per Constraint Region, which is always
+ *  applied and so isn't listed).  A RuleStage repeats its inner stage until it stalls, then gives each of its own rules a 
+ *  turn, and starts again if any of them made progress, so the cheap rules are always exhausted before a more expensive 
+ *  one is tried.  rules is the mask (one bit per RuleUsage::Rule) of every rule the stage can apply.
+ */
+struct NoRules
+{
+	enum { rules = 0 };
+	static bool apply( Grid&, RuleUsage&, const SolveOptions& ) { return false; }
+};
+
+template< RuleUsage::Rule head, typename Tail = NoRules >
+struct RuleList
+{
+	enum { rules = ( 1u << head ) | Tail::rules };
+	typedef char ruleIsNotUniquePerConstraintRegion[ head != RuleUsage::uniquePerConstraintRegion ? 1 : -1 ];
+	
+	static bool apply( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+	{
+		bool didWork = applyRuleAndUnique< head >( grid, usage, options );
+		didWork |= Tail::apply( grid, usage, options );  // Every rule gets its turn, whether or not an earlier one made progress
+		return didWork;
+	}
+};
+
+struct NoStage
+{
+	enum { rules = 0 };
+	static void run( Grid&, RuleUsage&, const SolveOptions& ) {}
+};
+
+template< typename Rules, typename Inner = NoStage >
+struct RuleStage
+{
+	enum { rules = Rules::rules | Inner::rules };
+	
+	static void run( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+	{
+		bool keepSearching = true;
+		while( keepSearching )
+		{
+			Inner::run( grid, usage, options );
+			keepSearching = Rules::apply( grid, usage, options );
+		}
+	}
+};
+
+/** Fixed, unless the options have a scheduler.  Then, each time Inner (the cheap stages at the core of Fixed) stalls, the 
+ *  rest of Fixed's rules are tried in the order the scheduler ranks them and Inner goes again as soon as one of them makes 
+ *  progress, rather than every rule of a stage getting its turn.  A rule that rarely pays off is only tried once the others 
+ *  have failed, and one that has never paid off for grids like this one is mostly not tried at all (see RuleScheduler).  
+ *  The rules don't always stall in the same place when they are applied in a different order either, so a hard puzzle can 
+ *  end up further on or further back than it would with Fixed.
+ */
+template< typename Inner, typename Fixed >
+struct AdaptiveStage
+{
+	enum { rules = Inner::rules | Fixed::rules, scheduled = Fixed::rules & ~Inner::rules };
+	
+	static void run( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+	{
+		if( !options.scheduler )
+		{
+			Fixed::run( grid, usage, options );
+			return;
+		}
+		
+		RuleUsage::Rule order[RuleUsage::numberOfRules];
+		bool keepSearching = true;
+		while( keepSearching )
+		{
+			Inner::run( grid, usage, options );
+			if( grid.contradiction || grid.solved() )
+			{
+				return;
+			}
+			const std::size_t candidates = grid.candidateCount();
+			const std::size_t count = options.scheduler->order( scheduled & options.rules, candidates, order );
+			keepSearching = false;
+			for( std::size_t loop = 0; loop != count && !keepSearching; ++loop )
+			{
+				if( grid.stalledAt[order[loop]] == candidates )
+				{
+					continue;  // Not a try, so not recorded
+				}
+				const uint64_t start = nanoseconds();
+				keepSearching = applyRuleAndUnique( grid, order[loop], usage, options );
+				options.scheduler->record( order[loop], candidates, candidates - grid.candidateCount(), nanoseconds() - start );
+			}
+		}
+	}
+};
+
+/// Only Spot and Unique Per Constraint Region, i.e., the naked and hidden singles
+typedef RuleStage< RuleList< RuleUsage::onlySpot > > SinglesRules;
+
+/// The singles and the rules that look no further than a region: Locked Tuples, Hidden Tuples and XYZ Wing
+typedef RuleStage< RuleList< RuleUsage::lockedTuples, RuleList< RuleUsage::hiddenTuples, RuleList< RuleUsage::xyzWing > > >,
+        SinglesRules > RegionRules;
+
+/// Every rule, in the order the solver has always used them
+typedef RuleStage< RuleList< RuleUsage::singleValueChains, RuleList< RuleUsage::multiValueChains > >, 
+        RuleStage< RuleList< RuleUsage::intersectReject, RuleList< RuleUsage::gridlock > >,
+        RegionRules > > FixedRules;
+
+/// Every rule, with Intersect Reject, Gridlock and the chains in the order a scheduler has learnt if there is one
+typedef AdaptiveStage< RegionRules, FixedRules > StandardRules;
+
+/** The rules used by solve and so by the Solver.  Building with, e.g., -DSUDOKU_RULES=SinglesRules makes a solver that
+    knows no other rules.
+*/
+#ifndef SUDOKU_RULES
+#define SUDOKU_RULES StandardRules
+#endif
+typedef SUDOKU_RULES SolverRules;
+
+
+/** Apply the rules until none of them can make any more progress.  Returns a summary of the rules that made progress. 
+    The cheap rules are repeated until they stall before each of the more expensive rules gets a turn.
+*/
+template< typename Rules >
+inline RuleUsage solve( Grid& grid, const SolveOptions& options )
+{
+	RuleUsage usage;
+	while( applyRule< RuleUsage::uniquePerConstraintRegion >( grid, options ) ){ usage.record( RuleUsage::uniquePerConstraintRegion ); }
+	
+	// Always give the rules a go, even if the candidates were already cleaned up (e.g., by the fast path)
+	Rules::run( grid, usage, options );
+	return usage;
+}
+
+inline RuleUsage solve( Grid& grid, const SolveOptions& options )
+{
+	return solve< SolverRules >( grid, options );
+}
+
+
+/** Check the grid for consistency (see Grid::consistent), with complete requiring every cell to be solved as well.  Returns 
+    true if it isn't consistent.  When verbose the regions are swept with Inconsistency instead, which explains what is wrong.
+*/
+inline bool do_check( Grid& grid, const bool complete, const SolveOptions& options )
+{
+	if( options.verbose )
+	{
+		return do_function( grid, Inconsistency( complete ), RuleStatistics::consistencyCheck, options );
+	}
+	
+	const uint64_t start = options.statistics ? nanoseconds() : 0;
+	const bool inconsistent = !grid.consistent( complete );
+	if( options.statistics )
+	{
+		options.statistics->record( RuleStatistics::consistencyCheck, Constraint::grid, inconsistent, 0, nanoseconds() - start );
+	}
+	return inconsistent;
+}
+
+
+/** Check the puzzle loaded into the grid for consistency, solve it and check the result.  The rules used are returned in usage.
+    Unless it is solved the grid is left as far as the rules got.
+*/
+inline SolveStatus::Type solveLoadedPuzzle( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+{
+	usage = RuleUsage();
+	
+	// Check grid for consistency
+	if( do_check( grid, false, options ) )
+	{		
+		return SolveStatus::inconsistent;
+	}
+
+	// From here on the grid notices as soon as the puzzle breaks (see Grid::candidatesChanged)
+	usage = solve( grid, options );
+	if( grid.contradiction )
+	{
+		return SolveStatus::inconsistent;
+	}
+	const bool overBudget = options.budget && options.budget->exceeded;
+	if( usage.applied == 0 )
+	{
+		return overBudget ? SolveStatus::budgetExceeded : SolveStatus::unsolved;
+	}
+	
+	if( options.verbose ) { std::cout << "Number of rules applied = " << usage.applied << std::endl; }
+		
+	// Check grid for consistency, unless propagating the values has already shown that it is solved
+	if( !grid.solved() && do_check( grid, true, options ) )
+	{
+		return overBudget ? SolveStatus::budgetExceeded : SolveStatus::unsolved;
+	}
+	return SolveStatus::solved;
+}
+
+/** Check the puzzle loaded into the grid for consistency, solve it and check the result.
+    Returns true if the grid now holds a complete and consistent solution.  The rules used are returned in usage.
+*/
+inline bool solvePuzzle( Grid& grid, RuleUsage& usage, const SolveOptions& options )
+{
+	return solveLoadedPuzzle( grid, usage, options ) == SolveStatus::solved;
+}
+
+} // namespace Sudoku
+
+#endif // SOLVE_HPP_20261019
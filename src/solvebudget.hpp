@@ -0,0 +1,139 @@
+/*
+ *  solvebudget.hpp
+ *
+ */
+
+#ifndef SOLVEBUDGET_HPP_20261019
+#define SOLVEBUDGET_HPP_20261019
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include "rulestatistics.hpp"
+
+namespace Sudoku {
+
+/** A limit on the work put into a single puzzle.  A limit of zero means no limit.
+ *  - maxNanoseconds      : wall time from start()
+ *  - maxRuleApplications : applications of any rule (to all the regions it is applied to)
+ *  - maxChainNodes       : cells visited by the chain searches, added up over all the searches
+ *  - maxChainLength      : the longest chain that is followed (longer chains are not explored but this doesn't end the solve)
+ *
+ *  The limits are set once and start() is called before each puzzle to reset what has been spent.  Once the budget is
+ *  exceeded every rule declines to run and the chain searches stop where they are, so the solve winds down quickly with
+ *  the grid as it was at that point (every elimination made until then is still sound).
+ *
+ *  The clock is only read once per rule application and once every clockInterval chain nodes so that keeping to the budget
+ *  costs next to nothing.
+ */
+struct SolveBudget
+{
+	explicit SolveBudget( const std::size_t maxRuleApplications = 0 )
+		: maxNanoseconds(0)
+		, maxRuleApplications( maxRuleApplications )
+		, maxChainNodes(0)
+		, maxChainLength(0)
+		, started(0)
+		, ruleApplications(0)
+		, chainNodes(0)
+		, exceeded(false)
+	{}
+
+	static const std::size_t clockInterval = 256;
+
+	void start()
+	{
+		started = maxNanoseconds ? nanoseconds() : 0;
+		ruleApplications = 0;
+		chainNodes = 0;
+		exceeded = false;
+	}
+
+	/// Count a rule application.  Returns false (and marks the budget as exceeded) if there are none left.
+	bool spendRuleApplication()
+	{
+		if( ( maxRuleApplications && ruleApplications >= maxRuleApplications ) || outOfTime() )
+		{
+			exceeded = true;
+		}
+		if( exceeded )
+		{
+			return false;
+		}
+		++ruleApplications;
+		return true;
+	}
+
+	/** Count a visit by a chain search to the end of a chain of the given length.
+	    Returns false if the chain shouldn't be extended, either because it is already as long as allowed or because the budget is exceeded.
+	*/
+	bool extendChain( const std::size_t length )
+	{
+		if( exceeded )
+		{
+			return false;
+		}
+		if( ( maxChainNodes && chainNodes >= maxChainNodes ) || ( ++chainNodes % clockInterval == 0 && outOfTime() ) )
+		{
+			exceeded = true;
+			return false;
+		}
+		return !maxChainLength || length < maxChainLength;
+	}
+
+	bool outOfTime() const
+	{
+		return maxNanoseconds && nanoseconds() - started >= maxNanoseconds;
+	}
+
+	/** Parse a comma separated list of limits, e.g., "ms=50,rules=1000,nodes=100000,length=12".
+	    Any limit not given is left as it is.  Throws std::runtime_error for anything that isn't understood.
+	*/
+	void parse( const string& limits )
+	{
+		string::size_type begin = 0;
+		while( begin < limits.size() )
+		{
+			string::size_type end = limits.find( ',', begin );
+			if( end == string::npos ) { end = limits.size(); }
+			const string limit = limits.substr( begin, end - begin );
+			begin = end + 1;
+
+			const string::size_type equals = limit.find( '=' );
+			char* valueEnd = 0;
+			const unsigned long value = ( equals == string::npos ) ? 0 : std::strtoul( limit.c_str() + equals + 1, &valueEnd, 10 );
+			if( equals == string::npos || equals + 1 == limit.size() || *valueEnd != '\0' )
+			{
+				throw std::runtime_error( "A budget limit must be name=number: " + limit );
+			}
+
+			const string name = limit.substr( 0, equals );
+			if( name == "ms" )          { maxNanoseconds = value * 1000000ULL; }
+			else if( name == "us" )     { maxNanoseconds = value * 1000ULL; }
+			else if( name == "rules" )  { maxRuleApplications = value; }
+			else if( name == "nodes" )  { maxChainNodes = value; }
+			else if( name == "length" ) { maxChainLength = value; }
+			else { throw std::runtime_error( "Unknown budget limit " + name ); }
+		}
+	}
+
+	uint64_t maxNanoseconds;
+	std::size_t maxRuleApplications;
+	std::size_t maxChainNodes;
+	std::size_t maxChainLength;
+
+	uint64_t started;
+	std::size_t ruleApplications;
+	std::size_t chainNodes;
+	bool exceeded;
+};
+
+} // namespace Sudoku
+
+#endif // SOLVEBUDGET_HPP_20261019
@@ -0,0 +1,194 @@
+/*
+ *  solver.cpp
+ *
+ */
+
+#include "solver.hpp"
+using namespace Sudoku;
+
+#include <algorithm>
+#include <stdexcept>
+
+
+Solver::Solver( const SolveOptions& options )
+	: budget_( options.budget ? *options.budget : SolveBudget() )
+	, scheduler_( options.scheduler ? *options.scheduler : RuleScheduler() )
+	, options_( options )
+	, grid_()
+{
+	if( options_.budget )
+	{
+		options_.budget = &budget_;
+	}
+	if( options_.scheduler )
+	{
+		options_.scheduler = &scheduler_;
+	}
+	if( options_.extraRegions )
+	{
+		grid_.addRegions( *options_.extraRegions );
+	}
+}
+
+Solver::Solver( const Solver& other )
+	: budget_( other.budget_ )
+	, scheduler_( other.scheduler_ )
+	, options_( other.options_ )
+	, grid_()
+{
+	if( options_.budget )
+	{
+		options_.budget = &budget_;
+	}
+	if( options_.scheduler )
+	{
+		options_.scheduler = &scheduler_;
+	}
+	if( options_.extraRegions )
+	{
+		grid_.addRegions( *options_.extraRegions );
+	}
+}
+
+SolveResult Solver::solve( const char* givens )
+{
+	const uint64_t start = nanoseconds();
+	setGivens( givens );
+	
+	SolveResult result;
+	if( !usesFastPath() )
+	{
+		grid_.load( givens_ );
+	}
+	else if( solveSingles( result ) )
+	{
+		result.nanoseconds = nanoseconds() - start;
+		return result;
+	}
+	solveRules( result, start );
+	return result;
+}
+
+void Solver::solve( const char* const* puzzles, const std::size_t count, SolveResult* results )
+{
+	if( !usesFastPath() || count == 0 )
+	{
+		for( std::size_t loop = 0; loop != count; ++loop ) { results[loop] = solve( puzzles[loop] ); }
+		return;
+	}
+	
+	const uint64_t batchStart = nanoseconds();
+	outcomes_.resize( count );
+	batch_.solve( puzzles, count, &outcomes_[0] );
+	const uint64_t share = ( nanoseconds() - batchStart ) / count;
+	
+	for( std::size_t loop = 0; loop != count; ++loop )
+	{
+		const uint64_t start = nanoseconds();
+		const BatchSingles::Outcome& outcome = outcomes_[loop];
+		SolveResult& result = results[loop];
+		result = SolveResult();
+		setGivens( puzzles[loop] );
+		
+		if( outcome.result == BitboardSingles::contradiction )
+		{
+			grid_.load( givens_ );
+		}
+		else
+		{
+			if( outcome.nakedSingles )  { result.usage.record( RuleUsage::uniquePerConstraintRegion ); }
+			if( outcome.hiddenSingles ) { result.usage.record( RuleUsage::onlySpot ); }
+			if( outcome.intersections ) { result.usage.record( RuleUsage::intersectReject ); }
+			if( outcome.result == BitboardSingles::solved )
+			{
+				std::copy( outcome.values, outcome.values + 81, result.values );
+				result.status = SolveStatus::solved;
+				result.nanoseconds = share;
+				continue;
+			}
+			std::copy( outcome.candidates, outcome.candidates + 729, result.candidates );
+			loadStalled( result.candidates );
+		}
+		solveRules( result, start );
+		result.nanoseconds += share;
+	}
+}
+
+bool Solver::usesFastPath() const
+{
+	return options_.fastPath && !options_.verbose && grid_.extras.empty()
+	    && options_.enabled( RuleUsage::uniquePerConstraintRegion ) && options_.enabled( RuleUsage::onlySpot ) 
+	    && options_.enabled( RuleUsage::intersectReject ) && ( SolverRules::rules & ( 1u << RuleUsage::intersectReject ) );
+}
+
+void Solver::setGivens( const char* givens )
+{
+	for( std::size_t index = 0; index != 81; ++index )
+	{
+		givens_[index] = ( givens[index] >= '1' && givens[index] <= '9' ) ? givens[index] : '0';
+	}
+}
+
+void Solver::solveRules( SolveResult& result, const uint64_t start )
+{
+	if( options_.budget ) { budget_.start(); }
+	if( options_.verbose ) { std::cout << grid_ << std::endl; }
+	
+	const RuleUsage fastPathUsage = result.usage;
+	result.status = solveLoadedPuzzle( grid_, result.usage, options_ );
+	for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule )
+	{
+		if( fastPathUsage.used( static_cast<RuleUsage::Rule>( rule ) ) ) { result.usage.record( static_cast<RuleUsage::Rule>( rule ) ); }
+	}
+	
+	grid_.values( result.values );
+	if( !result.solved() )
+	{
+		grid_.candidates( result.candidates );
+	}
+	result.nanoseconds = nanoseconds() - start;
+}
+
+bool Solver::solveSingles( SolveResult& result )
+{
+	const BitboardSingles::Result outcome = singles_.solve( givens_ );
+	if( outcome == BitboardSingles::contradiction )
+	{
+		// Leave it to the rules so that a bad puzzle is reported in the same way with or without the fast path
+		grid_.load( givens_ );
+		return false;
+	}
+	
+	if( singles_.nakedSingles )  { result.usage.record( RuleUsage::uniquePerConstraintRegion ); }
+	if( singles_.hiddenSingles ) { result.usage.record( RuleUsage::onlySpot ); }
+	if( singles_.intersections ) { result.usage.record( RuleUsage::intersectReject ); }
+	
+	if( outcome == BitboardSingles::solved )
+	{
+		singles_.values( result.values );
+		result.status = SolveStatus::solved;
+		return true;
+	}
+	
+	singles_.candidates( result.candidates );
+	loadStalled( result.candidates );
+	return false;
+}
+
+void Solver::loadStalled( const char* candidates )
+{
+	grid_.loadCandidates( candidates );
+	for( std::size_t index = 0; index != 81; ++index )
+	{
+		if( givens_[index] != '0' ) { grid_.cells[index].initial( givens_[index] ); }
+	}
+}
+
+SolveResult Solver::solve( const string& givens )
+{
+	if( givens.size() < 81 )
+	{
+		throw std::invalid_argument( "A puzzle needs 81 cells: " + givens );
+	}
+	return solve( givens.data() );
+}
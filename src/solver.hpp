@@ -0,0 +1,108 @@
+/*
+ *  solver.hpp
+ *
+ */
+
+#ifndef SOLVER_HPP_20261019
+#define SOLVER_HPP_20261019
+
+#include <stdint.h>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "batchsingles.hpp"
+#include "bitboardsingles.hpp"
+#include "grid.hpp"
+#include "rulescheduler.hpp"
+#include "ruleusage.hpp"
+#include "solve.hpp"
+#include "solvebudget.hpp"
+
+namespace Sudoku {
+
+/// Everything about the solve of one puzzle
+struct SolveResult
+{
+	SolveResult() : status( SolveStatus::unsolved ), usage(), nanoseconds(0) {}
+	
+	bool solved() const { return status == SolveStatus::solved; }
+	
+	SolveStatus::Type status;
+	RuleUsage usage;           // The rules that made progress
+	uint64_t nanoseconds;      // How long the solve took
+	char values[81];           // The value of each cell, '0' where it wasn't solved
+	char candidates[729];      // Unless solved, the candidates the rules left in each cell (see Grid::candidates)
+};
+
+
+/** Solves one puzzle after another, reusing the same grid.  This is the way to embed the solver in another program.
+ *
+ *  The options say which rules may be used, whether the steps are explained on stdout, where the statistics go and how
+ *  much work may be put into each puzzle.  If the options have a budget then the solver keeps its own copy of it (so each 
+ *  solver, e.g., one per thread, is charged separately) and a solve that runs out of budget stops early with the status
+ *  budgetExceeded and whatever the rules had worked out by then.  The same goes for a scheduler: the solver starts from a
+ *  copy of it and goes on learning from each puzzle it solves.  After a solve, grid() holds the candidates as the rules 
+ *  left them.
+ *
+ *  Unless the options turn it off (or add the extra regions of a variant, which it doesn't know), each puzzle first goes 
+ *  through BitboardSingles.  Only if that stalls is the grid loaded (with the candidates it has already eliminated) and 
+ *  handed to the rules, so an easy puzzle never touches the grid.
+ *  The fast path isn't counted in the rule statistics or charged to the budget.  Its work is recorded in the usage as
+ *  Unique Per Constraint Region (naked singles), Only Spot (hidden singles) and Intersect Reject.
+ *
+ *  Given a batch of puzzles, the fast path is BatchSingles instead, which works on many puzzles at once, and only the
+ *  puzzles that it stalls on are then solved one at a time.  The results are the same as solving them one by one.
+ *
+ *  A Solver is not thread safe but copies are independent of each other.
+ */
+class Solver
+{
+public:
+	explicit Solver( const SolveOptions& options = SolveOptions() );
+	Solver( const Solver& other );   // Gets its own grid, budget and scheduler (starting from what the other has learnt)
+	
+	/// Solve the puzzle given as 81 characters, '1'..'9' for a given and anything else for an empty cell
+	SolveResult solve( const char* givens );
+	SolveResult solve( const string& givens );
+	
+	/** Solve count puzzles, writing the result of each to the same position in results.  With the fast path, each 
+	    puzzle solved by BatchSingles is given an equal share of the time spent in it as its solve time.
+	*/
+	void solve( const char* const* puzzles, const std::size_t count, SolveResult* results );
+	
+	const Grid& grid() const { return grid_; }
+	const SolveOptions& options() const { return options_; }
+	const RuleScheduler& scheduler() const { return scheduler_; }
+
+private:
+	Solver& operator=( const Solver& );  // Not assignable (the options point to the budget and scheduler)
+	
+	bool usesFastPath() const;
+	void setGivens( const char* givens );
+	
+	/// Try the fast path.  Returns true if it solved the puzzle and otherwise leaves the grid ready for the rules.
+	bool solveSingles( SolveResult& result );
+	
+	/// Load the grid with the candidates that the fast path stalled on, keeping the givens marked as such
+	void loadStalled( const char* candidates );
+	
+	/// Apply the rules to the loaded grid and fill in the rest of the result
+	void solveRules( SolveResult& result, const uint64_t start );
+	
+	SolveBudget budget_;
+	RuleScheduler scheduler_;
+	SolveOptions options_;
+	Grid grid_;
+	BitboardSingles singles_;
+	BatchSingles batch_;
+	vector<BatchSingles::Outcome> outcomes_;
+	char givens_[81];
+};
+
+} // namespace Sudoku
+
+#endif // SOLVER_HPP_20261019
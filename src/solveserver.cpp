@@ -0,0 +1,261 @@
+/*
+ *  solveserver.cpp
+ *
+ */
+
+#include "solveserver.hpp"
+using namespace Sudoku;
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/// The longest request line that is read (anything longer can't be a puzzle)
+const std::size_t maxRequestSize = 1 << 12;
+
+/// How long the listener waits for a connection before checking whether it has been asked to stop
+const int stopCheckMilliseconds = 200;
+
+volatile sig_atomic_t stopRequested = 0;
+
+extern "C" void requestStop( int )
+{
+	stopRequested = 1;
+}
+
+/// Scoped lock of a mutex
+class Lock
+{
+public:
+	explicit Lock( pthread_mutex_t& mutex ) : mutex_( mutex ) { pthread_mutex_lock( &mutex_ ); }
+	~Lock() { pthread_mutex_unlock( &mutex_ ); }
+private:
+	pthread_mutex_t& mutex_;
+};
+
+} // anonymous namespace
+
+
+SolveServer::SolveServer( const SolveOptions& options, const ResultWriter::Format format, const PuzzleHook afterEachPuzzle )
+	: options_( options )
+	, format_( format )
+	, afterEachPuzzle_( afterEachPuzzle )
+	, connections_()
+{
+	if( format_ == ResultWriter::binary )
+	{
+		throw std::runtime_error( "The solve server can't answer in the binary format" );
+	}
+	options_.verbose = false;
+	pthread_mutex_init( &mutex_, 0 );
+	pthread_cond_init( &connectionReady_, 0 );
+}
+
+SolveServer::~SolveServer()
+{
+	pthread_cond_destroy( &connectionReady_ );
+	pthread_mutex_destroy( &mutex_ );
+}
+
+void SolveServer::serveStdio()
+{
+	Solver solver( options_ );
+	serve( solver, STDIN_FILENO, STDOUT_FILENO );
+}
+
+void SolveServer::serve( Solver& solver, const int in, const int out )
+{
+	ResultWriter writer( out, format_, 1 << 16 );
+	vector<char> buffer( maxRequestSize );
+	std::size_t used = 0;
+	bool discarding = false;   // Skipping the rest of a request that was too long
+	for( ;; )
+	{
+		const ssize_t received = ::read( in, &buffer[used], buffer.size() - used );
+		if( received < 0 && errno == EINTR ) { continue; }
+		if( received <= 0 ) { break; }
+		used += received;
+		
+		// Answer every complete line and keep any partial line for the next read
+		const char* lineStart = &buffer[0];
+		if( discarding )
+		{
+			const char* newline = static_cast<const char*>( std::memchr( lineStart, '\n', used ) );
+			discarding = ( newline == 0 );
+			lineStart = discarding ? lineStart + used : newline + 1;
+		}
+		for( const char* newline = static_cast<const char*>( std::memchr( lineStart, '\n', &buffer[0] + used - lineStart ) );
+		     newline;
+		     newline = static_cast<const char*>( std::memchr( lineStart, '\n', &buffer[0] + used - lineStart ) ) )
+		{
+			answer( solver, writer, lineStart, newline );
+			lineStart = newline + 1;
+		}
+		used -= lineStart - &buffer[0];
+		std::memmove( &buffer[0], lineStart, used );
+		
+		if( used == buffer.size() )
+		{
+			writer.writeError( "request too long" );
+			used = 0;
+			discarding = true;  // The rest of the line is part of the same request
+		}
+		writer.flush();
+	}
+	
+	// A final line without a newline
+	if( discarding ) { used = 0; }
+	answer( solver, writer, &buffer[0], &buffer[0] + used );
+	writer.flush();
+}
+
+void SolveServer::answer( Solver& solver, ResultWriter& writer, const char* begin, const char* end )
+{
+	while( end != begin && ( end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t' ) ) { --end; }
+	if( begin == end )
+	{
+		return;
+	}
+	
+	char givens[81];
+	bool isPuzzle = ( end - begin == 81 );
+	for( std::size_t index = 0; isPuzzle && index != 81; ++index )
+	{
+		const char value = begin[index];
+		isPuzzle = ( value >= '0' && value <= '9' ) || value == '.';
+		givens[index] = ( value == '.' ) ? '0' : value;
+	}
+	if( !isPuzzle )
+	{
+		writer.writeError( "not a puzzle: " + string( begin, end ) );
+		return;
+	}
+	
+	const SolveResult result = solver.solve( givens );
+	writer.write( givens, result.values, result.solved(), result.usage );
+	if( afterEachPuzzle_ ) { afterEachPuzzle_( solver.options() ); }
+}
+
+void SolveServer::serveSocket( const string& path, const std::size_t numberOfWorkers )
+{
+	sockaddr_un address;
+	std::memset( &address, 0, sizeof(address) );
+	address.sun_family = AF_UNIX;
+	if( path.size() >= sizeof(address.sun_path) )
+	{
+		throw std::runtime_error( "Socket path too long: " + path );
+	}
+	std::strcpy( address.sun_path, path.c_str() );
+	
+	const int listener = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( listener < 0 )
+	{
+		throw std::runtime_error( "Unable to create a socket" );
+	}
+	::unlink( path.c_str() );
+	if( ::bind( listener, reinterpret_cast<sockaddr*>( &address ), sizeof(address) ) != 0 || ::listen( listener, 64 ) != 0 )
+	{
+		::close( listener );
+		throw std::runtime_error( "Unable to listen on " + path );
+	}
+	
+	// A client that goes away mid answer must not take the server with it
+	std::signal( SIGPIPE, SIG_IGN );
+	std::signal( SIGINT, requestStop );
+	std::signal( SIGTERM, requestStop );
+	
+	vector<pthread_t> workers( numberOfWorkers == 0 ? 1 : numberOfWorkers );
+	for( vector<pthread_t>::iterator it = workers.begin(); it != workers.end(); ++it )
+	{
+		if( pthread_create( &*it, 0, &SolveServer::workerThread, this ) != 0 )
+		{
+			workers.erase( it, workers.end() );
+			stopWorkers( workers );
+			::close( listener );
+			::unlink( path.c_str() );
+			throw std::runtime_error( "Unable to start a server worker thread" );
+		}
+	}
+	
+	pollfd waiting;
+	waiting.fd = listener;
+	waiting.events = POLLIN;
+	while( !stopRequested )
+	{
+		if( ::poll( &waiting, 1, stopCheckMilliseconds ) <= 0 ) { continue; }
+		
+		const int connection = ::accept( listener, 0, 0 );
+		if( connection >= 0 )
+		{
+			Lock lock( mutex_ );
+			connections_.push_back( connection );
+			pthread_cond_signal( &connectionReady_ );
+		}
+	}
+	
+	stopWorkers( workers );
+	::close( listener );
+	::unlink( path.c_str() );
+}
+
+void SolveServer::stopWorkers( const vector<pthread_t>& workers )
+{
+	// Let the workers finish their current connections and then stop
+	{
+		Lock lock( mutex_ );
+		connections_.insert( connections_.end(), workers.size(), -1 );
+		pthread_cond_broadcast( &connectionReady_ );
+	}
+	for( vector<pthread_t>::const_iterator it = workers.begin(); it != workers.end(); ++it )
+	{
+		pthread_join( *it, 0 );
+	}
+}
+
+void* SolveServer::workerThread( void* self )
+{
+	static_cast<SolveServer*>( self )->work();
+	return 0;
+}
+
+void SolveServer::work()
+{
+	Solver solver( options_ );
+	for( ;; )
+	{
+		int connection = -1;
+		{
+			Lock lock( mutex_ );
+			while( connections_.empty() )
+			{
+				pthread_cond_wait( &connectionReady_, &mutex_ );
+			}
+			connection = connections_.front();
+			connections_.pop_front();
+		}
+		if( connection < 0 )
+		{
+			return;
+		}
+		
+		try
+		{
+			serve( solver, connection, connection );
+		}
+		catch( const std::exception& e )
+		{
+			std::cerr << "Connection dropped: " << e.what() << std::endl;
+		}
+		::close( connection );
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ *  solveserver.hpp
+ *
+ */
+
+#ifndef SOLVESERVER_HPP_20261019
+#define SOLVESERVER_HPP_20261019
+
+#include <pthread.h>
+
+#include <deque>
+using std::deque;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "resultwriter.hpp"
+#include "solve.hpp"
+#include "solver.hpp"
+
+namespace Sudoku {
+
+/** A long running solver that answers puzzles as they arrive, so that the cost of starting a process and building a grid
+ *  is paid once rather than for every puzzle.
+ *
+ *  A request is a line holding one puzzle in the line format (81 characters, '1'-'9' for a given and '.' or '0' for an 
+ *  empty cell).  Each request gets one result, in the result format, in the order the requests arrived.  A line that isn't 
+ *  a puzzle gets an error result instead (just one, however long the line); blank lines are ignored.  Results are flushed
+ *  whenever the requests received so far have all been answered, so a client can send one puzzle at a time and wait for
+ *  each answer or send many at once.
+ *
+ *  serveStdio answers the requests on stdin, on stdout.  serveSocket listens on a Unix socket and gives each connection to
+ *  one of a fixed set of worker threads, each of which keeps its own Solver for as long as the server runs.
+ *  The steps of each solve are never explained since that would be mixed in with the results.
+ */
+class SolveServer
+{
+public:
+	/// Called (on the worker's thread) after each puzzle is answered, e.g., to write statistics that have been asked for
+	typedef void (*PuzzleHook)( const SolveOptions& options );
+	
+	/// The format can be anything except binary.  Throws std::runtime_error for binary.
+	SolveServer( const SolveOptions& options, const ResultWriter::Format format, const PuzzleHook afterEachPuzzle = 0 );
+	~SolveServer();
+	
+	/// Answer the requests on stdin until it is closed
+	void serveStdio();
+	
+	/** Listen on a Unix socket (replacing any stale socket file at that path) until SIGINT or SIGTERM arrives.  
+	    Throws std::runtime_error if the socket can't be created.
+	*/
+	void serveSocket( const string& path, const std::size_t numberOfWorkers );
+
+	/// Answer the requests read from one file descriptor on another, until the input is closed
+	void serve( Solver& solver, const int in, const int out );
+
+private:
+	SolveServer( const SolveServer& );             // Not copyable
+	SolveServer& operator=( const SolveServer& );
+	
+	void answer( Solver& solver, ResultWriter& writer, const char* begin, const char* end );
+	
+	/// Tell the workers to finish once the connections already waiting are answered, and wait for them
+	void stopWorkers( const vector<pthread_t>& workers );
+	
+	static void* workerThread( void* self );
+	void work();
+	
+	SolveOptions options_;
+	const ResultWriter::Format format_;
+	const PuzzleHook afterEachPuzzle_;
+	
+	// Accepted connections waiting for a worker.  A connection of -1 tells a worker to finish.
+	pthread_mutex_t mutex_;
+	pthread_cond_t connectionReady_;
+	deque<int> connections_;
+};
+
+} // namespace Sudoku
+
+#endif // SOLVESERVER_HPP_20261019
@@ -2,213 +2,282 @@
 using std::cout;
 using std::endl;
 
-#include <iterator>
-using std::back_insert_iterator;
-using std::ostream_iterator;
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
 
-#include <algorithm>
-using std::copy;
-
-#include <sstream>
-using std::istringstream;
+#include <string>
+using std::string;
 
 #include <vector>
 using std::vector;
 
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
+
 #include "grid.hpp"
-#include "inconsistency.hpp"
-#include "uniqueperconstraintregion.hpp"
-#include "onlyspot.hpp"
-#include "lockedtuples.hpp"
-#include "hiddentuples.hpp"
-
-#include "intersectreject.hpp"
-#include "gridlock.hpp"
-#include "xyzwing.hpp"
-#include "singlevaluechains.hpp"
-#include "multivaluechains.hpp"
+#include "ruleusage.hpp"
+#include "solve.hpp"
+#include "solver.hpp"
+#include "solutionindex.hpp"
+#include "resultwriter.hpp"
+#include "pipeline.hpp"
+#include "solveserver.hpp"
 
 using namespace Sudoku;
 
-/** This version of for_each does the binding to the 4 arguments needed for func to work */
-template< typename Function >
-void for_each( vector<ConstraintRegion>& cont, Function func, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
+
+/// Set by SIGUSR1 to ask for the rule statistics to be written (once the current puzzle is finished)
+static volatile sig_atomic_t statisticsRequested = 0;
+
+extern "C" void requestStatistics( int )
 {
-	vector<ConstraintRegion>::iterator it = cont.begin();
-	for( ; it != cont.end(); ++it )
+	statisticsRequested = 1;
+}
+
+/// If the statistics have been asked for then write them to stderr
+void writeRequestedStatistics( const SolveOptions& options )
+{
+	if( options.statistics && __atomic_exchange_n( &statisticsRequested, 0, __ATOMIC_RELAXED ) )
 	{
-		func( *it, changedCells, explanatoryCells, explanation );
+		options.statistics->write( std::cerr );
 	}
 }
 
-
-template< typename Function >
-bool do_grid_function( Grid& grid, Function func, const Constraint::Type type )
+/** If the index is open and has the puzzle then fill in the result from it. */
+bool findSolution( const Solver& solver, SolutionIndex& index, const char* givens, SolveResult& result )
 {
-	bool didWork = false;
-	//	apply_merge( grid, func, changedCells, explanatoryCells, explanation );
-	set<Cell*> changedCells;
-	set<Cell*> explanatoryCells;
-	string explanation;
-	
-	vector<ConstraintRegion>& regions = grid.get(type);
-	for( vector<ConstraintRegion>::iterator it = regions.begin(); it != regions.end(); ++it )
+	if( !index.isOpen() || !index.find( givens, result.values, &result.usage ) )
 	{
-		func( *it, grid, changedCells, explanatoryCells, explanation );
-	}		
-	
-	if(changedCells.size() > 0)
-	{ 
-		cout << "Apply " << func.name() << " rule to " << Constraint::typeToStr( type ) << "s.\n"; 
-		//copy (changedCells.begin(), changedCells.end(), ostream_iterator<std::size_t> (cout, " "));
-		cout << explanation << endl << grid << endl;
-		didWork = true;
+		return false;
 	}
-	return didWork;
+	if( solver.options().verbose ) { std::cout << "Solution found in index. Number of rules applied = " << result.usage.applied << std::endl; }
+	result.status = SolveStatus::solved;
+	return true;
 }
 
-
-template< typename Function >
-bool do_function( Grid& grid, Function func, const Constraint::Type type )
+/** Solve the puzzle.  If the index is open then it is consulted before solving and any new solution is added to it.
+    If fromIndex isn't null it is set to whether the solution came from the index.
+*/
+SolveResult solvePuzzle( Solver& solver, SolutionIndex& index, const char* givens, bool* fromIndex = 0 )
 {
-	bool didWork = false;
-	//	apply_merge( grid, func, changedCells, explanatoryCells, explanation );
-	set<Cell*> changedCells;
-	set<Cell*> explanatoryCells;
-	string explanation;
+	SolveResult result;
+	const bool found = findSolution( solver, index, givens, result );
+	if( fromIndex ) { *fromIndex = found; }
+	if( found )
+	{
+		return result;
+	}
 	
-	vector<ConstraintRegion>& regions = grid.get(type);
-	for( vector<ConstraintRegion>::iterator it = regions.begin(); it != regions.end(); ++it )
+	result = solver.solve( givens );
+	if( result.solved() && index.isOpen() )
 	{
-		func( *it, changedCells, explanatoryCells, explanation );
-	}	
-
-	if(changedCells.size() > 0)
-	{ 
-		cout << "Apply " << func.name() << " rule to " << Constraint::typeToStr( type ) << "s.\n"; 
-		//copy (changedCells.begin(), changedCells.end(), ostream_iterator<std::size_t> (cout, " "));
-		cout << explanation << endl << grid << endl;
-		didWork = true;
+		index.insert( givens, result.values, result.usage );
 	}
-	return didWork;
+	return result;
 }
 
 
-template< typename Function >
-bool do_function( Grid& grid, Function func )
+/** Solve every puzzle in the given file (see CorpusReader for the formats).  
+    If there is a result writer then every result goes to it.  Otherwise the solutions are written, as CSV blocks, 
+    to a file next to the puzzle file and only puzzles that are solved get a block.  A rerun over a file whose puzzles 
+    all come from the index leaves the solution file that is already there as it is, since it would be written the same.
+*/
+void solveFile( const string& filename, SolutionIndex& index, ResultWriter* results, const SolveOptions& options )
 {
-	bool didWork = false;
-	didWork |= do_function( grid, func, Constraint::square );
-	didWork |= do_function( grid, func, Constraint::row );
-	didWork |= do_function( grid, func, Constraint::column );
+	CorpusReader reader( filename );
+	const string solutionFilename = filename + ".solution.csv";
+	ofstream solutionFile;  // Only created once there is a solution to put in it
+	
+	// Until it is known that the solution file needs writing, the solutions are kept in pending
+	bool rewrite = results || !index.isOpen() || !ifstream( solutionFilename.c_str() );
+	string pending;
+	
+	Solver solver( options );
+	char givens[81];
+	char formatted[maxFormattedSize];
+	while( reader.next( givens ) )
+	{
+		bool fromIndex = false;
+		const SolveResult result = solvePuzzle( solver, index, givens, &fromIndex );
+		writeRequestedStatistics( options );
+		rewrite = rewrite || !fromIndex;
+		if( results )
+		{
+			results->write( givens, result.values, result.solved(), result.usage );
+		}
+		else if( result.solved() )
+		{
+			pending.append( formatted, formatCSV( result.values, formatted ) );
+		}
 		
-	return didWork;
+		if( rewrite && !pending.empty() )
+		{
+			if( !solutionFile.is_open() )
+			{
+				solutionFile.open( solutionFilename.c_str() );
+			}
+			solutionFile.write( pending.data(), pending.size() );
+			pending.clear();
+		}
+	}
+	if( options.scheduler )
+	{
+		*options.scheduler = solver.scheduler();  // The next file starts from what was learnt on this one
+	}
 }
 
-template< typename Function >
-bool do_grid_function( Grid& grid, Function func, bool doRow, bool doColumn, bool doSquare )
 
+/** Solves the puzzles for a Pipeline.  Every copy (i.e., every solver thread) has its own Solver.  The puzzles that aren't
+    in the index are solved as a batch so that the Solver can put them through BatchSingles together.
+*/
+struct PipelineSolver
 {
-	bool didWork = false;
+	static const std::size_t batchSize = 4 * BatchSingles::lanes;
 	
-	if( doRow )
-	{
-		didWork |= do_grid_function( grid, func, Constraint::row );	
-	}
-	if( doColumn )
+	PipelineSolver( SolutionIndex& index, const SolveOptions& options ) : index_( &index ), solver_( options ), results_( batchSize ) {}
+	
+	void operator()( PipelineJob* jobs, const std::size_t count )
 	{
-		didWork |= do_grid_function( grid, func, Constraint::column );	
+		const char* puzzles[batchSize] = {};
+		PipelineJob* unsolved[batchSize];
+		std::size_t numberUnsolved = 0;
+		for( std::size_t loop = 0; loop != count; ++loop )
+		{
+			SolveResult found;
+			if( findSolution( solver_, *index_, jobs[loop].givens, found ) )
+			{
+				copyResult( found, jobs[loop] );
+				continue;
+			}
+			puzzles[numberUnsolved] = jobs[loop].givens;
+			unsolved[numberUnsolved++] = &jobs[loop];
+		}
+		
+		solver_.solve( puzzles, numberUnsolved, &results_[0] );
+		for( std::size_t loop = 0; loop != numberUnsolved; ++loop )
+		{
+			if( results_[loop].solved() && index_->isOpen() )
+			{
+				index_->insert( puzzles[loop], results_[loop].values, results_[loop].usage );
+			}
+			copyResult( results_[loop], *unsolved[loop] );
+		}
+		writeRequestedStatistics( solver_.options() );
 	}
-	if( doSquare )
+	
+private:
+	static void copyResult( const SolveResult& result, PipelineJob& job )
 	{
-		didWork |= do_grid_function( grid, func, Constraint::square );	
+		job.solved = result.solved();
+		job.usage = result.usage;
+		std::copy( result.values, result.values + 81, job.values );
 	}
 	
-	return didWork;
-}
+	SolutionIndex* index_;
+	Solver solver_;
+	vector<SolveResult> results_;
+};
 
 
+/** Usage: sudoku [-q] [-s] [-a] [-b budget] [-x regions] [-i index_file] [-o result_file [-f line|csv|binary|json] [-j solver_threads]] puzzle_file...
+           sudoku [-s] [-a] [-b budget] [-x regions] [-f line|csv|json] [-j worker_threads] -S|-u socket_path
+    -q stops the explanation of each step of the solve being written to stdout.
+    -s counts and times every rule and writes the statistics to stderr at exit (and whenever SIGUSR1 arrives).
+    -a tries Intersect Reject, Gridlock and the chains in the order they have paid off in so far (see RuleScheduler), 
+       learnt afresh by each solver from the puzzles it solves.
+    -b limits the work on each puzzle, e.g., "ms=50,rules=1000,nodes=100000,length=12" (see SolveBudget).  A puzzle that runs
+       out of budget is left unsolved.
+    -x adds the regions of a variant to every grid: "x" (the diagonals), "windoku" or a file of regions (see ExtraRegions),
+       or with "jigsaw:" and a file of regions puts those in place of the squares.  It may be given more than once.  The index knows nothing of variants, so it can't be used with -x.
+    -j reads, solves and writes concurrently (see Pipeline) with the given number of solver threads.  It implies -q.
+    The index file remembers solutions between runs so that puzzles which have already been solved are not solved again,
+    and a solution file is left alone when every puzzle in its puzzle file was found there.
+    The result file (- for stdout) collects the results of every puzzle into one file instead of a solution file per puzzle file.
+    Writing them to stdout implies -q.
+    -S and -u run a solve server (see SolveServer) that answers puzzles, one per line, from stdin or from connections to a 
+    Unix socket (with the given number of worker threads) until stdin is closed or SIGINT/SIGTERM arrives.
+*/
 int main( int argc, char* argv[] )
 {	
-    Grid grid;
-    assert(argc > 1);
-	grid.parse( argv[1] );
-    cout << grid << endl;
-
-	//std::for_each(grid.rows.begin(), grid.rows.end(), PrintCellLocationInformation());
-    //std::for_each(grid.columns.begin(), grid.columns.end(), PrintCellLocationInformation());
-    //std::for_each(grid.squares.begin(), grid.squares.end(), PrintCellLocationInformation());
+	SolutionIndex index;
+	SolveOptions options;
+	RuleStatistics statistics;
+	SolveBudget budget;
+	RuleScheduler scheduler;
+	ExtraRegions extraRegions;
+	string resultFilename;
+	ResultWriter::Format resultFormat = ResultWriter::csv;
+	bool resultFormatGiven = false;
+	std::size_t solverThreads = 0;
+	bool serveStdio = false;
+	string socketPath;
 	
-	// Check grid for consistency
-	if( do_function( grid, Inconsistency() ) )
-	{		
-		return 0;
-	}
-
-	std::size_t countRulesApplied = 0;
-	bool keepSearching = false;
-	while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-	
-    while( keepSearching )
+	int argIndex = 1;
+	while( argIndex < argc && argv[argIndex][0] == '-' && argv[argIndex][1] != '\0' )
 	{
-		while( keepSearching )
-		{
-			while( keepSearching )
-			{
-				while( keepSearching )
-				{
-					keepSearching = false;
-					if( do_function( grid, OnlySpot() ) ){ keepSearching = true; ++countRulesApplied; }
-					while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }						
-				}
-				
-				if( do_function( grid, LockedTuples() ) ){ keepSearching = true; ++countRulesApplied; }
-				while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-				
-				if( do_function( grid, HiddenTuples() ) ){ keepSearching = true; ++countRulesApplied; }
-				while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-				
-				if( do_grid_function( grid, XYZWing(), false, false, true ) ){ keepSearching = true; ++countRulesApplied; }
-				while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-			}
-
-			if( do_grid_function( grid, IntersectReject(), true, true, true ) ){ keepSearching = true; ++countRulesApplied; }
-			while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-
-			if( do_grid_function( grid, Gridlock(), true, true, false ) ){ keepSearching = true; ++countRulesApplied; }
-			while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-		}	
+		const string option = argv[argIndex++];
+		if( option == "-q" )      { options.verbose = false; continue; }
+		if( option == "-s" )      { options.statistics = &statistics; std::signal( SIGUSR1, requestStatistics ); continue; }
+		if( option == "-a" )      { options.scheduler = &scheduler; continue; }
+		if( option == "-S" )      { serveStdio = true; continue; }
 		
-		if( do_grid_function( grid, SingleValueChains(), true, false, false ) ){ keepSearching = true; ++countRulesApplied; }
-		while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
-		
-		//cout << "Starting MultiValueChains search" << endl;
-		if( do_grid_function( grid, MultiValueChains(), true, false, false ) ){ keepSearching = true; ++countRulesApplied; }
-		//cout << "Finished MultiValueChains search" << endl;
-		while( do_function( grid, UniquePerConstraintRegion() ) ){ keepSearching = true; ++countRulesApplied; }
+		if( argIndex == argc )    { throw std::runtime_error( option + " needs a value" ); }
+		if( option == "-i" )      { index.open( argv[argIndex] ); }
+		else if( option == "-o" ) { resultFilename = argv[argIndex]; }
+		else if( option == "-f" ) { resultFormat = ResultWriter::formatFromName( argv[argIndex] ); resultFormatGiven = true; }
+		else if( option == "-j" ) { solverThreads = std::strtoul( argv[argIndex], 0, 10 ); }
+		else if( option == "-u" ) { socketPath = argv[argIndex]; }
+		else if( option == "-b" ) { budget.parse( argv[argIndex] ); options.budget = &budget; }
+		else if( option == "-x" ) { extraRegions.parse( argv[argIndex] ); options.extraRegions = &extraRegions; }
+		else { throw std::runtime_error( "Unknown option " + option ); }
+		++argIndex;
 	}
 	
-	if( countRulesApplied > 0 )
+	if( options.extraRegions && index.isOpen() ) { throw std::runtime_error( "-x can't be used with an index (-i)" ); }
+	
+	if( serveStdio || !socketPath.empty() )
 	{
-		std::cout << "Number of rules applied = " << countRulesApplied << std::endl; 
+		// The answers go straight back to whoever asked, one line each unless another format was asked for
+		SolveServer server( options, resultFormatGiven ? resultFormat : ResultWriter::line, writeRequestedStatistics );
+		if( serveStdio ) { server.serveStdio(); }
+		else             { server.serveSocket( socketPath, solverThreads ); }
 		
-		// Check grid for consistency		
-		if( do_function( grid, Inconsistency(true) ) )
-		{ 
-		   /*
-			cout << "Grid is inconsistent or incomplete.  Inconsistent/Incomplete cells are: ";
-			for( vector<std::size_t>::const_iterator it = inconsistentCells.begin(); it != inconsistentCells.end(); ++it )
-			{
-				cout << "index = " << *it << ' ' << grid.cells[*it].row() << ' ' << grid.cells[*it].column() << ' ' << grid.cells[*it].square() << "\t";
-			}
-			cout << endl; */
-			return 0;
+		if( options.statistics )
+		{
+			statistics.write( std::cerr );
 		}
+		return 0;
+	}
+    assert(argc > argIndex);
+	
+	if( resultFilename == "-" )
+	{
+		options.verbose = false;  // The explanations would be mixed in with the results
+	}
+	ResultWriter* results = resultFilename.empty() ? 0 : new ResultWriter( resultFilename, resultFormat );
+	if( solverThreads > 0 )
+	{
+		if( !results ) { throw std::runtime_error( "-j needs a result file (-o)" ); }
 		
-		grid.writeCSV((string(argv[1]) + ".solution.csv").c_str() );		
+		options.verbose = false;  // The explanations from different threads would be interleaved
+		const vector<string> filenames( argv + argIndex, argv + argc );
+		Pipeline<PipelineSolver> pipeline( filenames, PipelineSolver( index, options ), solverThreads );
+		pipeline.run( *results );
+		argIndex = argc;
+	}
+	
+	for( ; argIndex < argc; ++argIndex )
+	{
+		solveFile( argv[argIndex], index, results, options );
+	}
+	delete results;  // Flushes any buffered results
+	
+	if( options.statistics )
+	{
+		statistics.write( std::cerr );
 	}
-
 
     return 0;
 }
-
@@ -0,0 +1,314 @@
+/*
+ *  differential.cpp
+ *
+ *  Check that the rules are sound by running them side by side with a brute force solver.
+ *
+ *  Usage: differential [-n puzzles] [-s seed] [-j threads] [corpus_directory_or_file...]
+ *
+ *  Without any files, random puzzles with a unique solution are generated (a random complete grid with clues removed
+ *  for as long as the solution stays unique).  The same seed always gives the same puzzles.  With files, their puzzles
+ *  are used instead (any without a unique solution are skipped).
+ *
+ *  The brute force solver gives the true solution.  The rules are then applied one at a time, always trying them in order
+ *  and starting again from the first rule after any progress, and after every application each cell must still have its
+ *  true value as a candidate.  The first application that breaks this is reported with the rule, every elimination it
+ *  made (the wrong ones marked) and the candidates before it ran, in the format read by microbench, so it can be replayed.
+ *  The puzzles are shared out between the threads (one per processor by default).
+ */
+
+#include "../bruteforce.hpp"
+#include "../solve.hpp"
+#include "../corpusreader.hpp"
+using namespace Sudoku;
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <ostream>
+using std::ostream;
+
+#include <sstream>
+using std::ostringstream;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+
+const std::size_t snapshotSize = 729;
+
+/// Counts over all the puzzles checked
+struct Totals
+{
+	Totals() : puzzles(0), skipped(0), solved(0), unsound(0) { std::fill( applications, applications + RuleUsage::numberOfRules, 0 ); }
+
+	std::size_t puzzles;
+	std::size_t skipped;
+	std::size_t solved;
+	std::size_t unsound;
+	std::size_t applications[RuleUsage::numberOfRules];  ///< Productive applications of each rule
+	
+	void add( const Totals& other )
+	{
+		puzzles += other.puzzles;
+		skipped += other.skipped;
+		solved  += other.solved;
+		unsound += other.unsound;
+		for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule ) { applications[rule] += other.applications[rule]; }
+	}
+};
+
+
+/// xorshift32
+uint32_t nextRandom( uint32_t& state )
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/// Make a puzzle with a unique solution from a random complete grid by removing clues (in random order) while the solution stays unique
+void generatePuzzle( BruteForce& oracle, const uint32_t seed, char* givens )
+{
+	oracle.randomSolution( givens, seed );
+
+	std::size_t order[81];
+	for( std::size_t index = 0; index != 81; ++index ) { order[index] = index; }
+	uint32_t state = seed * 2654435761u + 1;
+	for( std::size_t last = 80; last != 0; --last )
+	{
+		std::swap( order[last], order[nextRandom( state ) % ( last + 1 )] );
+	}
+
+	char solution[81];
+	for( std::size_t step = 0; step != 81; ++step )
+	{
+		const char value = givens[order[step]];
+		givens[order[step]] = '0';
+		if( oracle.solve( givens, solution ) != 1 )
+		{
+			givens[order[step]] = value;
+		}
+	}
+}
+
+void writeEliminations( ostream& os, const char* before, const char* after, const char* solution )
+{
+	for( std::size_t index = 0; index != 81; ++index )
+	{
+		for( std::size_t digit = 0; digit != 9; ++digit )
+		{
+			const std::size_t position = 9 * index + digit;
+			if( before[position] != '.' && after[position] == '.' )
+			{
+				const bool wrong = solution[index] == before[position];
+				os << ( wrong ? "  *r" : "   r" ) << index / 9 + 1 << 'c' << index % 9 + 1 << '-' << before[position]
+				   << ( wrong ? " (the solution has this value)\n" : "\n" );
+			}
+		}
+	}
+}
+
+/** Apply the rules to the puzzle one application at a time, checking each cell still has its solution value as a candidate.
+    Returns false (after writing a report to os) at the first application that eliminates a solution value.
+*/
+bool checkPuzzle( Grid& grid, const char* givens, const char* solution, Totals& totals, ostream& os )
+{
+	SolveOptions options;
+	options.verbose = false;
+
+	char before[snapshotSize];
+	char after[snapshotSize];
+	grid.load( givens );
+
+	bool progress = true;
+	while( progress )
+	{
+		progress = false;
+		for( std::size_t rule = 0; rule != RuleUsage::numberOfRules && !progress; ++rule )
+		{
+			grid.candidates( before );
+			if( !applyRule( grid, static_cast<RuleUsage::Rule>( rule ), options ) )
+			{
+				continue;
+			}
+			progress = true;
+			++totals.applications[rule];
+
+			grid.candidates( after );
+			for( std::size_t index = 0; index != 81; ++index )
+			{
+				if( after[9 * index + solution[index] - '1'] == '.' )
+				{
+					os << RuleStatistics::name( rule ) << " eliminated a solution value\n"
+					   << "  puzzle   " << string( givens, 81 ) << '\n'
+					   << "  solution " << string( solution, 81 ) << '\n'
+					   << "  eliminations:\n";
+					writeEliminations( os, before, after, solution );
+					os << "  candidates before:\n" << string( before, snapshotSize ) << '\n';
+					return false;
+				}
+			}
+		}
+	}
+
+	if( grid.candidateCount() == 81 )
+	{
+		++totals.solved;
+	}
+	return true;
+}
+
+/// The puzzles shared by the checking threads, which take the next puzzle in turn
+struct Work
+{
+	const vector<string>* puzzles;
+	std::size_t next;
+	pthread_mutex_t outputMutex;
+};
+
+struct Checker
+{
+	Work* work;
+	Totals totals;
+};
+
+extern "C" void* checkPuzzles( void* argument )
+{
+	Checker& checker = *static_cast<Checker*>( argument );
+	Work& work = *checker.work;
+	BruteForce oracle;
+	Grid grid;
+	char solution[81];
+	for( std::size_t index = __atomic_fetch_add( &work.next, 1, __ATOMIC_RELAXED );
+	     index < work.puzzles->size();
+	     index = __atomic_fetch_add( &work.next, 1, __ATOMIC_RELAXED ) )
+	{
+		const char* givens = (*work.puzzles)[index].data();
+		if( oracle.solve( givens, solution ) != 1 )
+		{
+			++checker.totals.skipped;
+			continue;
+		}
+		++checker.totals.puzzles;
+		
+		ostringstream report;
+		if( !checkPuzzle( grid, givens, solution, checker.totals, report ) )
+		{
+			++checker.totals.unsound;
+			pthread_mutex_lock( &work.outputMutex );
+			cout << report.str() << std::flush;
+			pthread_mutex_unlock( &work.outputMutex );
+		}
+	}
+	return 0;
+}
+
+Totals checkAll( const vector<string>& puzzles, const std::size_t numberOfThreads )
+{
+	Work work;
+	work.puzzles = &puzzles;
+	work.next = 0;
+	pthread_mutex_init( &work.outputMutex, 0 );
+	
+	vector<Checker> checkers( numberOfThreads );
+	vector<pthread_t> threads( numberOfThreads );
+	for( std::size_t thread = 0; thread != numberOfThreads; ++thread )
+	{
+		checkers[thread].work = &work;
+		if( pthread_create( &threads[thread], 0, checkPuzzles, &checkers[thread] ) != 0 )
+		{
+			throw std::runtime_error( "Unable to create a checking thread" );
+		}
+	}
+	
+	Totals totals;
+	for( std::size_t thread = 0; thread != numberOfThreads; ++thread )
+	{
+		pthread_join( threads[thread], 0 );
+		totals.add( checkers[thread].totals );
+	}
+	pthread_mutex_destroy( &work.outputMutex );
+	return totals;
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		std::size_t numberOfPuzzles = 100;
+		uint32_t seed = 1;
+		const long processors = sysconf( _SC_NPROCESSORS_ONLN );
+		std::size_t numberOfThreads = processors > 0 ? processors : 1;
+		int argIndex = 1;
+		while( argIndex + 1 < argc && argv[argIndex][0] == '-' )
+		{
+			const string option = argv[argIndex++];
+			if( option == "-n" )      { numberOfPuzzles = std::strtoul( argv[argIndex++], 0, 10 ); }
+			else if( option == "-s" ) { seed = std::strtoul( argv[argIndex++], 0, 10 ); }
+			else if( option == "-j" ) { numberOfThreads = std::max( 1ul, std::strtoul( argv[argIndex++], 0, 10 ) ); }
+			else { throw std::runtime_error( "Usage: differential [-n puzzles] [-s seed] [-j threads] [corpus_directory_or_file...]" ); }
+		}
+
+		vector<string> filenames;
+		for( int pathIndex = argIndex; pathIndex != argc; ++pathIndex )
+		{
+			if( isPuzzleFile( argv[pathIndex] ) ) { filenames.push_back( argv[pathIndex] ); }
+			else                                  { findPuzzleFiles( argv[pathIndex], filenames ); }
+		}
+
+		vector<string> puzzles;
+		char givens[81];
+		BruteForce oracle;
+		if( filenames.empty() )
+		{
+			for( std::size_t number = 0; number != numberOfPuzzles; ++number )
+			{
+				generatePuzzle( oracle, seed + static_cast<uint32_t>( number ), givens );
+				puzzles.push_back( string( givens, 81 ) );
+			}
+		}
+		for( vector<string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it )
+		{
+			CorpusReader reader( *it );
+			while( reader.next( givens ) )
+			{
+				puzzles.push_back( string( givens, 81 ) );
+			}
+		}
+
+		const uint64_t start = nanoseconds();
+		const Totals totals = checkAll( puzzles, numberOfThreads );
+
+		cout << totals.puzzles << " puzzles checked (" << totals.skipped << " skipped without a unique solution), "
+		     << totals.solved << " solved by the rules, " << totals.unsound << " with an unsound elimination, "
+		     << ( nanoseconds() - start ) / 1000000 << "ms\n"
+		     << "Productive applications:";
+		for( std::size_t rule = 0; rule != RuleUsage::numberOfRules; ++rule )
+		{
+			cout << ( rule ? ", " : " " ) << RuleStatistics::name( rule ) << ' ' << totals.applications[rule];
+		}
+		cout << endl;
+
+		return totals.unsound ? 1 : 0;
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+}
@@ -0,0 +1,385 @@
+/*
+ *  regression.cpp
+ *
+ *  Check the solver against the solutions checked in alongside the corpora.
+ *
+ *  Usage: regression [-j threads] [-u unsolved_list] [corpus_directory_or_file...]
+ *
+ *  Every puzzle is solved in memory (nothing is written to disk) and compared with the stored solution in the
+ *  puzzle file's ".solution.csv".  The solution file only holds the puzzles that were solved, in order, so a stored
+ *  solution belongs to a puzzle when it agrees with the puzzle's givens.  Each puzzle then ends up as one of
+ *  - passed       : solved, and identical to the stored solution
+ *  - mismatched   : solved, but different to the stored solution
+ *  - unsolved     : a solution is stored but the puzzle is no longer solved
+ *  - newly solved : solved, but there is no stored solution to compare with
+ *  - known unsolved : not solved and there is no stored solution either
+ *  - expected unsolved : a solution is stored but the puzzle is on the unsolved list and isn't solved
+ *  Mismatched and unsolved puzzles are failures and make the exit status non-zero.
+ *
+ *  The unsolved list (data/unsolved.list unless -u names another) holds the puzzles, with stored solutions, that the
+ *  rules are known not to solve, one per line as the puzzle file (the end of its path is enough) and the puzzle's number
+ *  in it, e.g., "mx/mx.925.csv 1".  Blank lines and lines starting with '#' are skipped.  A listed puzzle that is solved 
+ *  is reported so that it can be taken off the list.  The wall time, the total solve
+ *  time and the slowest puzzles are reported so a slow down shows up alongside any wrong answers.
+ *
+ *  The puzzles of a variant are told apart by the files alongside the puzzle file: a ".regions" file holds the regions 
+ *  to add and a ".jigsaw" file the regions that replace the squares, in the format of a region file for sudoku -x (see
+ *  ExtraRegions).
+ */
+
+#include "../solve.hpp"
+#include "../solver.hpp"
+#include "../corpusreader.hpp"
+using namespace Sudoku;
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+using std::sort;
+
+#include <cstdlib>
+#include <cstring>
+
+#include <fstream>
+using std::ifstream;
+
+#include <list>
+using std::list;
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <sstream>
+using std::istringstream;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+
+struct Case
+{
+	enum Outcome { passed, mismatched, unsolved, newlySolved, knownUnsolved, expectedUnsolved, numberOfOutcomes };
+
+	string filename;
+	std::size_t number;       ///< Position of the puzzle within its file
+	char givens[81];
+	bool hasSolution;
+	bool listedUnsolved;      ///< On the unsolved list
+	char solution[81];        ///< The stored solution (only if hasSolution)
+	char values[81];          ///< What the solver came up with ('0' for unsolved cells)
+	const ExtraRegions* regions;  ///< The regions of a variant, or null
+	Outcome outcome;
+	uint64_t nanoseconds;
+};
+
+const char* outcomeName( const Case::Outcome outcome )
+{
+	static const char* names[] = { "passed", "mismatched", "unsolved", "newly solved", "known unsolved", "expected unsolved" };
+	return names[outcome];
+}
+
+/// True if the solution has every given of the puzzle in the same place
+bool agrees( const char* givens, const char* solution )
+{
+	for( std::size_t index = 0; index != 81; ++index )
+	{
+		if( givens[index] != '0' && givens[index] != solution[index] )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// A puzzle on the unsolved list
+struct ListedPuzzle
+{
+	string filename;          ///< The puzzle file or the end of its path
+	std::size_t number;
+};
+
+/// Read the unsolved list (see above).  A list that doesn't exist is empty.
+vector<ListedPuzzle> loadUnsolvedList( const string& filename )
+{
+	vector<ListedPuzzle> listed;
+	ifstream fin( filename.c_str() );
+	string line;
+	for( std::size_t lineNumber = 1; std::getline( fin, line ); ++lineNumber )
+	{
+		if( line.find_first_not_of( " \t\r" ) == string::npos || line[line.find_first_not_of( " \t\r" )] == '#' )
+		{
+			continue;
+		}
+		istringstream iss( line );
+		ListedPuzzle puzzle;
+		if( !( iss >> puzzle.filename >> puzzle.number ) )
+		{
+			std::ostringstream oss;
+			oss << filename << ':' << lineNumber << ": expected a puzzle file and the puzzle's number";
+			throw std::runtime_error( oss.str() );
+		}
+		listed.push_back( puzzle );
+	}
+	return listed;
+}
+
+/// True if the case is the listed puzzle, the listed file name being the whole of the case's path or the end of it after a '/'
+bool isListed( const Case& current, const ListedPuzzle& puzzle )
+{
+	const string& path = current.filename;
+	const string& end = puzzle.filename;
+	if( current.number != puzzle.number || path.size() < end.size() || path.compare( path.size() - end.size(), end.size(), end ) != 0 )
+	{
+		return false;
+	}
+	return path.size() == end.size() || path[path.size() - end.size() - 1] == '/';
+}
+
+/// The regions of the variant that the puzzle file is for (see above), if it is for one, added to variants.  Otherwise null.
+const ExtraRegions* loadVariant( const string& filename, list<ExtraRegions>& variants )
+{
+	const string regionsFilename = filename + ".regions";
+	const string jigsawFilename = filename + ".jigsaw";
+	const bool hasRegions = access( regionsFilename.c_str(), R_OK ) == 0;
+	const bool isJigsaw = access( jigsawFilename.c_str(), R_OK ) == 0;
+	if( !hasRegions && !isJigsaw )
+	{
+		return 0;
+	}
+	
+	variants.push_back( ExtraRegions() );
+	if( hasRegions ) { variants.back().parse( regionsFilename ); }
+	if( isJigsaw )   { variants.back().parse( "jigsaw:" + jigsawFilename ); }
+	return &variants.back();
+}
+
+/// Load the puzzles of the file and pair them with the stored solutions
+void loadCases( const string& filename, vector<Case>& cases, list<ExtraRegions>& variants )
+{
+	vector<string> solutions;
+	const string solutionFilename = filename + ".solution.csv";
+	if( access( solutionFilename.c_str(), R_OK ) == 0 )
+	{
+		CorpusReader solutionReader( solutionFilename, CorpusReader::csv );
+		char solution[81];
+		while( solutionReader.next( solution ) )
+		{
+			solutions.push_back( string( solution, 81 ) );
+		}
+	}
+
+	CorpusReader reader( filename );
+	vector<string>::const_iterator nextSolution = solutions.begin();
+	Case current;
+	current.filename = filename;
+	current.number = 0;
+	current.regions = loadVariant( filename, variants );
+	while( reader.next( current.givens ) )
+	{
+		++current.number;
+		current.hasSolution = nextSolution != solutions.end() && agrees( current.givens, nextSolution->data() );
+		if( current.hasSolution )
+		{
+			std::memcpy( current.solution, nextSolution->data(), 81 );
+			++nextSolution;
+		}
+		cases.push_back( current );
+	}
+
+	if( nextSolution != solutions.end() )
+	{
+		throw std::runtime_error( solutionFilename + " has solutions that don't match any puzzle in " + filename );
+	}
+}
+
+void runCase( Solver& solver, Case& current )
+{
+	const SolveResult result = solver.solve( current.givens );
+	const bool solved = result.solved();
+	current.nanoseconds = result.nanoseconds;
+	std::memcpy( current.values, result.values, 81 );
+
+	if( current.hasSolution )
+	{
+		if( !solved && current.listedUnsolved )                       { current.outcome = Case::expectedUnsolved; }
+		else if( !solved )                                            { current.outcome = Case::unsolved; }
+		else if( std::memcmp( current.values, current.solution, 81 ) ) { current.outcome = Case::mismatched; }
+		else                                                          { current.outcome = Case::passed; }
+	}
+	else
+	{
+		current.outcome = solved ? Case::newlySolved : Case::knownUnsolved;
+	}
+}
+
+
+/// The cases shared by the solver threads, which take the next case in turn
+struct Work
+{
+	vector<Case>* cases;
+	std::size_t next;
+};
+
+extern "C" void* solveCases( void* argument )
+{
+	Work& work = *static_cast<Work*>( argument );
+	SolveOptions options;
+	options.verbose = false;
+	Solver solver( options );
+	for( std::size_t index = __atomic_fetch_add( &work.next, 1, __ATOMIC_RELAXED );
+	     index < work.cases->size();
+	     index = __atomic_fetch_add( &work.next, 1, __ATOMIC_RELAXED ) )
+	{
+		Case& current = (*work.cases)[index];
+		if( current.regions )
+		{
+			// There are only a few variant puzzles, so each gets a solver of its own
+			SolveOptions variantOptions( options );
+			variantOptions.extraRegions = current.regions;
+			Solver variantSolver( variantOptions );
+			runCase( variantSolver, current );
+		}
+		else
+		{
+			runCase( solver, current );
+		}
+	}
+	return 0;
+}
+
+void solveAll( vector<Case>& cases, const std::size_t numberOfThreads )
+{
+	Work work;
+	work.cases = &cases;
+	work.next = 0;
+
+	vector<pthread_t> threads( numberOfThreads );
+	for( vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it )
+	{
+		if( pthread_create( &*it, 0, solveCases, &work ) != 0 )
+		{
+			throw std::runtime_error( "Unable to create a solver thread" );
+		}
+	}
+	for( vector<pthread_t>::iterator it = threads.begin(); it != threads.end(); ++it )
+	{
+		pthread_join( *it, 0 );
+	}
+}
+
+void printGrid( const char* label, const char* cells )
+{
+	cout << "    " << label << ' ' << string( cells, 81 ) << '\n';
+}
+
+bool slower( const Case* lhs, const Case* rhs )
+{
+	return lhs->nanoseconds > rhs->nanoseconds;
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		const long processors = sysconf( _SC_NPROCESSORS_ONLN );
+		std::size_t numberOfThreads = processors > 0 ? processors : 1;
+		string unsolvedListFilename = "data/unsolved.list";
+		int argIndex = 1;
+		while( argIndex + 1 < argc && argv[argIndex][0] == '-' )
+		{
+			const string option = argv[argIndex++];
+			if( option == "-j" )      { numberOfThreads = std::max( 1ul, std::strtoul( argv[argIndex++], 0, 10 ) ); }
+			else if( option == "-u" ) { unsolvedListFilename = argv[argIndex++]; }
+			else { throw std::runtime_error( "Usage: regression [-j threads] [-u unsolved_list] [corpus_directory_or_file...]" ); }
+		}
+
+		vector<string> paths( argv + argIndex, argv + argc );
+		if( paths.empty() )
+		{
+			paths.push_back( "data" );
+		}
+
+		vector<string> filenames;
+		for( vector<string>::const_iterator it = paths.begin(); it != paths.end(); ++it )
+		{
+			if( isPuzzleFile( *it ) ) { filenames.push_back( *it ); }
+			else                      { findPuzzleFiles( *it, filenames ); }
+		}
+
+		vector<Case> cases;
+		list<ExtraRegions> variants;
+		for( vector<string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it )
+		{
+			loadCases( *it, cases, variants );
+		}
+		
+		const vector<ListedPuzzle> unsolvedList = loadUnsolvedList( unsolvedListFilename );
+		for( vector<Case>::iterator it = cases.begin(); it != cases.end(); ++it )
+		{
+			it->listedUnsolved = false;
+			for( vector<ListedPuzzle>::const_iterator listedIt = unsolvedList.begin(); listedIt != unsolvedList.end() && !it->listedUnsolved; ++listedIt )
+			{
+				it->listedUnsolved = isListed( *it, *listedIt );
+			}
+		}
+
+		const uint64_t start = nanoseconds();
+		solveAll( cases, numberOfThreads );
+		const uint64_t wall = nanoseconds() - start;
+
+		std::size_t counts[Case::numberOfOutcomes] = {};
+		uint64_t total = 0;
+		vector<const Case*> bySpeed;
+		for( vector<Case>::const_iterator it = cases.begin(); it != cases.end(); ++it )
+		{
+			++counts[it->outcome];
+			total += it->nanoseconds;
+			bySpeed.push_back( &*it );
+
+			if( it->outcome == Case::mismatched || it->outcome == Case::unsolved )
+			{
+				cout << outcomeName( it->outcome ) << ": " << it->filename << " #" << it->number << '\n';
+				printGrid( "puzzle  ", it->givens );
+				printGrid( "expected", it->solution );
+				printGrid( "got     ", it->values );
+			}
+			else if( it->outcome == Case::newlySolved || it->outcome == Case::expectedUnsolved )
+			{
+				cout << outcomeName( it->outcome ) << ": " << it->filename << " #" << it->number << '\n';
+			}
+			else if( it->outcome == Case::passed && it->listedUnsolved )
+			{
+				cout << "solved but on the unsolved list: " << it->filename << " #" << it->number << '\n';
+			}
+		}
+
+		sort( bySpeed.begin(), bySpeed.end(), slower );
+		cout << "Slowest puzzles:\n";
+		for( std::size_t rank = 0; rank != std::min<std::size_t>( 5, bySpeed.size() ); ++rank )
+		{
+			cout << "    " << bySpeed[rank]->nanoseconds / 1000 << "us " << bySpeed[rank]->filename << " #" << bySpeed[rank]->number << '\n';
+		}
+
+		cout << filenames.size() << " files, " << cases.size() << " puzzles";
+		for( std::size_t outcome = 0; outcome != Case::numberOfOutcomes; ++outcome )
+		{
+			cout << ", " << counts[outcome] << ' ' << outcomeName( static_cast<Case::Outcome>( outcome ) );
+		}
+		cout << "\n" << wall / 1000000 << "ms wall, " << total / 1000000 << "ms solving on " << numberOfThreads << " threads" << endl;
+
+		return ( counts[Case::mismatched] || counts[Case::unsolved] ) ? 1 : 0;
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+}
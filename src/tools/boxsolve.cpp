@@ -0,0 +1,105 @@
+/*
+ *  boxsolve.cpp
+ *
+ *  Solve 4x4, 9x9, 16x16 and 25x25 puzzles with the singles and intersections of BoxSingles.
+ *
+ *  Usage: boxsolve puzzle_file...
+ *
+ *  Each line of a puzzle file is one puzzle, a row at a time, and its length gives the size of the grid (16, 81, 256 or
+ *  625 characters).  The digits are the symbols of BoxTraits: 1-4, 1-9, 1-9 then A-G, and A-Y.  Any other character is
+ *  an empty cell.  Blank lines and lines starting with '#' are skipped.
+ *
+ *  Every puzzle is written to stdout, one line each, with the cells that were solved filled in ('.' for the others)
+ *  followed by solved, stalled or contradiction.  The rule engine only knows 9x9 grids so the larger puzzles only get
+ *  the simplest rules, and a stalled one needs more than those.
+ */
+
+#include "../bitboardsingles.hpp"
+using namespace Sudoku;
+
+#include <fstream>
+using std::ifstream;
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+
+struct Totals
+{
+	Totals() : solved(0), stalled(0), contradiction(0) {}
+
+	std::size_t solved;
+	std::size_t stalled;
+	std::size_t contradiction;
+};
+
+template< std::size_t order >
+void solve( const string& puzzle, Totals& totals )
+{
+	static BoxSingles<order> singles;  // Too big for the stack once the boxes are large
+	const typename BoxSingles<order>::Result result = singles.solve( puzzle.c_str() );
+
+	string values( BoxGeometry<order>::numberOfCells, '0' );
+	singles.values( &values[0] );
+	for( string::iterator it = values.begin(); it != values.end(); ++it )
+	{
+		if( *it == '0' ) { *it = '.'; }
+	}
+
+	switch( result )
+	{
+		case BoxSingles<order>::solved        : cout << values << " solved\n";        ++totals.solved;        break;
+		case BoxSingles<order>::stalled       : cout << values << " stalled\n";       ++totals.stalled;       break;
+		case BoxSingles<order>::contradiction : cout << puzzle << " contradiction\n"; ++totals.contradiction; break;
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		if( argc < 2 )
+		{
+			cerr << "Usage: boxsolve puzzle_file..." << endl;
+			return 1;
+		}
+
+		Totals totals;
+		for( int argIndex = 1; argIndex != argc; ++argIndex )
+		{
+			ifstream fin( argv[argIndex] );
+			if( !fin ) { throw std::runtime_error( string( "Unable to open " ) + argv[argIndex] ); }
+
+			string line;
+			for( std::size_t lineNumber = 1; std::getline( fin, line ); ++lineNumber )
+			{
+				const string::size_type last = line.find_last_not_of( " \t\r" );
+				line.erase( last == string::npos ? 0 : last + 1 );
+				if( line.empty() || line[0] == '#' ) { continue; }
+
+				switch( line.size() )
+				{
+					case 16  : solve<2>( line, totals ); break;
+					case 81  : solve<3>( line, totals ); break;
+					case 256 : solve<4>( line, totals ); break;
+					case 625 : solve<5>( line, totals ); break;
+					default  : cerr << argv[argIndex] << ':' << lineNumber << ": not a 4x4, 9x9, 16x16 or 25x25 puzzle\n"; break;
+				}
+			}
+		}
+		cerr << totals.solved << " solved, " << totals.stalled << " stalled, " << totals.contradiction << " contradictions" << endl;
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
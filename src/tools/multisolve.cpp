@@ -0,0 +1,151 @@
+/*
+ *  multisolve.cpp
+ *
+ *  Solve samurai (and other overlapping) sudokus with MultiGrid.
+ *
+ *  Usage: multisolve [-v] [-l top,left;top,left;...] puzzle_file...
+ *
+ *  A puzzle is the lines of its layout, e.g., 21 lines of 21 characters for a samurai: '1'-'9' for a given, '.' or '0' for
+ *  an empty cell and a space where no grid covers the layout.  Puzzles follow each other in a file, separated by any
+ *  number of blank lines or lines starting with '#'.
+ *
+ *  The grids are those of a samurai unless -l gives the top left corner (row and column on the layout) of each grid.
+ *  -v explains each step of the solve.  Every puzzle is written to stdout as its layout with the solved cells filled in
+ *  ('.' for the others), followed by a line with how the solve ended and the number of rule applications.
+ */
+
+#include "../multigrid.hpp"
+using namespace Sudoku;
+
+#include <cstdlib>
+
+#include <fstream>
+using std::ifstream;
+
+#include <iostream>
+using std::cerr;
+using std::cout;
+using std::endl;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+
+/// Parse "top,left;top,left;..."
+vector<MultiGrid::Placement> parsePlacements( const string& description )
+{
+	vector<MultiGrid::Placement> placements;
+	string::size_type begin = 0;
+	while( begin < description.size() )
+	{
+		string::size_type end = description.find( ';', begin );
+		if( end == string::npos ) { end = description.size(); }
+		const string corner = description.substr( begin, end - begin );
+		begin = end + 1;
+
+		char* topEnd = 0;
+		const unsigned long top = std::strtoul( corner.c_str(), &topEnd, 10 );
+		char* leftEnd = 0;
+		const unsigned long left = ( *topEnd == ',' ) ? std::strtoul( topEnd + 1, &leftEnd, 10 ) : 0;
+		if( *topEnd != ',' || topEnd + 1 == leftEnd || *leftEnd != '\0' )
+		{
+			throw std::runtime_error( "A grid's corner must be top,left: " + corner );
+		}
+		placements.push_back( MultiGrid::Placement( top, left ) );
+	}
+	if( placements.empty() )
+	{
+		throw std::runtime_error( "No grids in " + description );
+	}
+	return placements;
+}
+
+/// Read the lines of the next puzzle.  Returns false at the end of the file.
+bool nextPuzzle( ifstream& fin, const std::size_t height, vector<string>& layout )
+{
+	layout.clear();
+	string line;
+	while( layout.size() != height && std::getline( fin, line ) )
+	{
+		if( !line.empty() && line[line.size() - 1] == '\r' ) { line.erase( line.size() - 1 ); }
+		const bool blank = line.find_first_not_of( " \t" ) == string::npos || line[0] == '#';
+		if( !blank )
+		{
+			layout.push_back( line );
+		}
+		else if( !layout.empty() )
+		{
+			throw std::runtime_error( "A puzzle ended early" );
+		}
+	}
+	if( !layout.empty() && layout.size() != height )
+	{
+		throw std::runtime_error( "A puzzle ended early" );
+	}
+	return !layout.empty();
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		SolveOptions options;
+		options.verbose = false;
+		vector<MultiGrid::Placement> placements = MultiGrid::samurai();
+
+		int argIndex = 1;
+		while( argIndex < argc && argv[argIndex][0] == '-' )
+		{
+			const string option = argv[argIndex++];
+			if( option == "-v" )                      { options.verbose = true; }
+			else if( option == "-l" && argIndex < argc ) { placements = parsePlacements( argv[argIndex++] ); }
+			else { throw std::runtime_error( "Unknown option " + option ); }
+		}
+		if( argIndex == argc )
+		{
+			cerr << "Usage: multisolve [-v] [-l top,left;top,left;...] puzzle_file..." << endl;
+			return 1;
+		}
+
+		MultiGrid grids( placements );
+		std::size_t solved = 0;
+		std::size_t count = 0;
+		for( ; argIndex < argc; ++argIndex )
+		{
+			ifstream fin( argv[argIndex] );
+			if( !fin )
+			{
+				throw std::runtime_error( string( "Unable to open " ) + argv[argIndex] );
+			}
+
+			vector<string> layout;
+			while( nextPuzzle( fin, grids.height(), layout ) )
+			{
+				grids.load( layout );
+				RuleUsage usage;
+				const SolveStatus::Type status = grids.solve( usage, options );
+				solved += ( status == SolveStatus::solved ) ? 1 : 0;
+				++count;
+
+				grids.values( layout );
+				for( vector<string>::const_iterator it = layout.begin(); it != layout.end(); ++it )
+				{
+					cout << *it << '\n';
+				}
+				cout << SolveStatus::typeToStr( status ) << ", " << usage.applied << " rules applied\n\n";
+			}
+		}
+		cerr << solved << " of " << count << " puzzles solved" << endl;
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *  sdkconvert.cpp
+ *
+ *  Convert puzzle files between the formats understood by CorpusReader.
+ *
+ *  Usage: sdkconvert [-f line|sdk|csv|binary] input_file... output_file
+ *
+ *  The input formats are determined by the file extensions.  Unless -f is given, so is the output format.
+ *  Every puzzle in every input file ends up (in order) in the one output file.
+ */
+
+#include "../corpusreader.hpp"
+#include "../puzzleformat.hpp"
+using namespace Sudoku;
+
+#include <iostream>
+using std::cerr;
+using std::endl;
+
+#include <fstream>
+using std::ofstream;
+
+#include <stdexcept>
+
+#include <string>
+using std::string;
+
+
+CorpusReader::Format formatFromName( const string& name )
+{
+	if( name == "line" )   { return CorpusReader::line; }
+	if( name == "sdk" )    { return CorpusReader::sdk; }
+	if( name == "csv" )    { return CorpusReader::csv; }
+	if( name == "binary" ) { return CorpusReader::binary; }
+	throw std::runtime_error( "Unknown format " + name );
+}
+
+std::size_t format( const CorpusReader::Format outputFormat, const char* cells, char* out )
+{
+	switch( outputFormat )
+	{
+		case CorpusReader::line   : return formatLine( cells, out );   break;
+		case CorpusReader::sdk    : return formatSDK( cells, out );    break;
+		case CorpusReader::csv    : return formatCSV( cells, out );    break;
+		case CorpusReader::binary : return formatBinary( cells, out ); break;
+		default: throw std::runtime_error("Impossible output format");
+	}
+}
+
+int main( int argc, char* argv[] )
+{
+	try
+	{
+		int argIndex = 1;
+		CorpusReader::Format outputFormat = CorpusReader::automatic;
+		if( argc > 2 && string( argv[1] ) == "-f" )
+		{
+			outputFormat = formatFromName( argv[2] );
+			argIndex = 3;
+		}
+		if( argc - argIndex < 2 )
+		{
+			cerr << "Usage: sdkconvert [-f line|sdk|csv|binary] input_file... output_file" << endl;
+			return 1;
+		}
+		
+		const string outputFilename = argv[argc - 1];
+		if( outputFormat == CorpusReader::automatic )
+		{
+			outputFormat = CorpusReader::formatFromFilename( outputFilename );
+		}
+		
+		ofstream fout( outputFilename.c_str(), std::ios::binary );
+		if( !fout )
+		{
+			throw std::runtime_error( "Unable to create " + outputFilename );
+		}
+		
+		char buffer[maxFormattedSize];
+		if( outputFormat == CorpusReader::binary )
+		{
+			fout.write( buffer, formatBinaryHeader( buffer ) );
+		}
+		
+		std::size_t count = 0;
+		char givens[81];
+		for( ; argIndex < argc - 1; ++argIndex )
+		{
+			CorpusReader reader( argv[argIndex] );
+			while( reader.next( givens ) )
+			{
+				fout.write( buffer, format( outputFormat, givens, buffer ) );
+				++count;
+			}
+		}
+		
+		if( !fout.flush() )
+		{
+			throw std::runtime_error( "Unable to write " + outputFilename );
+		}
+		cerr << "Converted " << count << " puzzles into " << outputFilename << endl;
+	}
+	catch( const std::exception& e )
+	{
+		cerr << e.what() << endl;
+		return 1;
+	}
+    return 0;
+}
@@ -15,6 +15,7 @@ using std::set;
 using std::ostringstream;
 
 #include "constraintregion.hpp"
+#include "grid.hpp"
 
 
 namespace Sudoku {
@@ -48,6 +49,74 @@ struct UniquePerConstraintRegion
 			}
 		}
 	}
+	
+	/** The same rule for the whole grid at once without the explanations: every solved cell that hasn't been propagated yet
+	    is queued, and each cell taken off the queue has its value removed from its peers (Grid::peers, the 20 cells that 
+	    share a row, column or square with it and those sharing any extra regions), queueing any peer that is left with a 
+	    single candidate.  So each placement is propagated exactly once, rather than being looked at again by every
+	    sweep of the regions, and the queue is run until it is empty so one call does what repeated sweeps would.
+	    
+	    Consistency is kept as it goes.  A placement whose value is already placed in one of its regions (Grid::placed) sets
+	    Grid::contradiction, as does an elimination that empties a peer or leaves a digit nowhere to go in a region (see 
+	    Grid::candidatesChanged), and the propagation stops there.  Returns true if any candidate was removed.
+	*/
+	static bool propagate( Grid& grid )
+	{
+		if( grid.contradiction )
+		{
+			return false;
+		}
+		
+		std::size_t queue[81];
+		std::size_t queued = 0;
+		for( std::size_t index = 0; index != 81; ++index )
+		{
+			Cell& cell = grid.cells[index];
+			if( cell.candidates().size() == 1 && !cell.propagated() )
+			{
+				cell.propagated( true );  // Stops the cell being queued twice
+				queue[queued++] = index;
+			}
+		}
+		
+		bool didWork = false;
+		while( queued )
+		{
+			const std::size_t index = queue[--queued];
+			const char value = grid.cells[index].value();
+			const CandidateSet::Mask bit = CandidateSet::bit( value );
+			const vector<std::size_t>& regions = grid.regionsOfCell[index];
+			for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
+			{
+				if( grid.placed[*regionIt] & bit )
+				{
+					grid.contradiction = true;
+					return true;
+				}
+				grid.placed[*regionIt] |= bit;
+			}
+			const vector<Cell*>& peers = grid.peers[index];
+			for( vector<Cell*>::const_iterator peerIt = peers.begin(); peerIt != peers.end(); ++peerIt )
+			{
+				Cell& other = **peerIt;
+				if( !other.remove( value ) )
+				{
+					continue;
+				}
+				didWork = true;
+				if( grid.contradiction )
+				{
+					return true;
+				}
+				if( other.candidates().size() == 1 && !other.propagated() )
+				{
+					other.propagated( true );
+					queue[queued++] = other.index();
+				}
+			}
+		}
+		return didWork;
+	}
 };
 
 } // namespace Sudoku
@@ -33,10 +33,11 @@ struct XYZWing
 	const char* name() const { return "XYZ Wing"; }
 	static const bool usesGrid = true;
 	
-	// Only call this with squares.
+	// Only call this with squares or the extra regions of a variant (the pivot region), not rows or columns.
 	void operator()( ConstraintRegion& cr, Grid& grid, set<Cell*>& changedCells, set<Cell*>& explanatoryCells, string& explanation )
 	{
-		assert( Constraint::calculateType(cr) == Constraint::square );
+		const std::size_t pivot = grid.regionNumber( cr );
+		assert( pivot >= 18 );
 		
 		Cell* pXYZCell = 0;
 		while( (pXYZCell = findXYZ( cr, pXYZCell )) )
@@ -47,7 +48,7 @@ struct XYZWing
 			{
 				// The YZ cell must now _not_ be in the same square as the XYZ cell (if it was this would be a locked triple instead)
 				Cell* pYZCell = 0;
-				while( (pYZCell = findYZ( grid, pXYZCell, pXZCell, pYZCell )) )
+				while( (pYZCell = findYZ( grid, pivot, pXYZCell, pXZCell, pYZCell )) )
 				{
 					// Figure out the actual value of Z
 					vector< char > intersection;
@@ -55,7 +56,7 @@ struct XYZWing
 					assert( intersection.size() == 1 );
 					const char candidateZ = intersection[0];
 					
-					// eliminate Z in the intersection of the square and row/column of YZ
+					// eliminate Z from the cells of the square that YZ can see (those on its row or column, in a regular grid)
 					ostringstream oss;
 					oss << "XYZ wing composed of XYZ ";
 					pXYZCell->writeCellLocationInformation(oss);
@@ -70,14 +71,16 @@ struct XYZWing
 					set<const Cell*> preserveCells;
 					preserveCells.insert( pXYZCell );
 					preserveCells.insert( pXZCell );					
-					Constraint::eliminate( pYZCell, grid.get( Constraint::square )[pXYZCell->square()], candidateZ, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );
+					Constraint::eliminate( grid, pYZCell, cr, candidateZ, oss.str(), changedCells, explanatoryCells, explanation, preserveCells );
 				}
 			}
 		}
 	}
 	
 private:	
-	Cell* findYZ( const Grid& grid, const Cell* pXYZCell, const Cell* pXZCell, const Cell* pYZCell )  
+	/// The next YZ cell after pYZCell (or the first if it is null).  It is looked for in the regions of the XYZ cell other than
+	/// the pivot region (its row and then its column, in a regular grid), but not in the pivot region itself.
+	Cell* findYZ( const Grid& grid, const std::size_t pivot, const Cell* pXYZCell, const Cell* pXZCell, const Cell* pYZCell )  
 	{
 		assert( pXYZCell->candidates().size() == 3 );
 		assert( pXZCell->candidates().size() == 2 );
@@ -92,43 +95,44 @@ private:
 		assert( difference.size() == 1 );
 		candidateY = difference[0];
 		
-		// Need to search the row and column that the XYZ cell occupies
-		for( Constraint::Type crType = static_cast<Constraint::Type>(0); crType != Constraint::square; crType = static_cast<Constraint::Type>(crType + 1) )
+		// Need to search the regions (other than the pivot) that the XYZ cell occupies
+		const vector<std::size_t>& regions = grid.regionsOfCell[pXYZCell->index()];
+		bool resumed = pYZCell == 0;
+		for( vector<std::size_t>::const_iterator regionIt = regions.begin(); regionIt != regions.end(); ++regionIt )
 		{
-			// If the previous pYZCell comes from being found in a column then fastforward onto checking columns
-			if( pYZCell && (crType == Constraint::row) && (pYZCell->column() == pXYZCell->column()) )
-			{
-				crType = static_cast<Constraint::Type>(crType + 1);
-			}
+			if( *regionIt == pivot ) { continue; }
 			
-			ConstraintRegion cr = grid.get(crType)[ pXYZCell->index(crType) ];			
-			ConstraintRegion::iterator crIt = cr.begin();
+			const ConstraintRegion& cr = grid.region( *regionIt );
+			ConstraintRegion::const_iterator crIt = cr.begin();
 			
-			// If we have already tested a YZ from the row/column that we are about to search through then fast-forward crIt to start at pYZCell
-			if( pYZCell && (find(cr.begin(), cr.end(), pYZCell) != cr.end() ) )
+			// If we have already tested a YZ from a region then fast-forward crIt to start after pYZCell in the first region that has it
+			if( !resumed )
 			{
-				while( (*crIt) != pYZCell && crIt != cr.end() )
-				{
-					++crIt;
-				}
-				if( crIt != cr.end() )
-				{
-					++crIt;
-				}
+				crIt = find( cr.begin(), cr.end(), pYZCell );
+				if( crIt == cr.end() ) { continue; }
+				++crIt;
+				resumed = true;
 			}
 			
 			for( ; crIt != cr.end(); ++crIt )
 			{
 				const Cell::CandidateContainer currentCandidates = (*crIt)->candidates();
 				if( currentCandidates.size() == 2
-				   && find( currentCandidates.begin(), currentCandidates.end(), candidateY ) != currentCandidates.end() )
+				   && currentCandidates.contains( candidateY ) )
 				{
 					// << "Candidates is 2 and candidateY " << candidateY << " is in candidates." << endl;
-					if( find( currentCandidates.begin(), currentCandidates.end(), candidate1 ) != currentCandidates.end()
-					   || find( currentCandidates.begin(), currentCandidates.end(), candidate3 ) != currentCandidates.end() )
+					if( currentCandidates.contains( candidate1 )
+					   || currentCandidates.contains( candidate3 ) )
 					{
-						// The YZ cell must now _not_ be in the same square as the XYZ cell (if it was this would be a locked triple instead)
-						if( (*crIt)->square() != pXYZCell->square() )
+						// The YZ cell must now _not_ be in the pivot region (if it was this would be a locked triple instead),
+						// nor in an earlier region of the XYZ cell (where it has already been found)
+						const vector<std::size_t>& yzRegions = grid.regionsOfCell[(*crIt)->index()];
+						bool seen = find( yzRegions.begin(), yzRegions.end(), pivot ) != yzRegions.end();
+						for( vector<std::size_t>::const_iterator earlierIt = regions.begin(); earlierIt != regionIt && !seen; ++earlierIt )
+						{
+							seen = *earlierIt != pivot && find( yzRegions.begin(), yzRegions.end(), *earlierIt ) != yzRegions.end();
+						}
+						if( !seen )
 						{
 							return *crIt;	
 						}